@@ -61,6 +61,7 @@ ILOSTLBEGIN
 
 /* #include "timer.h" */
 #include "options_dm.h"
+#include "writer_dm.h"
 
 using namespace std;
 
@@ -88,7 +89,8 @@ struct INSTANCE {
     double  *f;    //!< Fixed costs
     double  *s;    //!< Capacity
     double  *d;    //!< Demand
-    double **c;    //!< Allocation costs
+    double **c;    //!< Allocation costs (rows of one contiguous block)
+    double  *cT;   //!< Allocation costs, customer-major (cT[j*nF+i])
     double   totS; //!< Total supply
     double   totD; //!< Total demand
 
@@ -132,7 +134,7 @@ int timeLimit;
 
 /****************** FUNCTIONS DECLARATION ***************************/
 int readProblemData(char * _FILENAME, int fType, INSTANCE & inp);
-void printOptions(char * _FILENAME, INSTANCE inp, int timeLimit);
+void printOptions(char * _FILENAME, INSTANCE & inp, int timeLimit);
 void GenerateDemand(int multiplier);
 /****************** FUNCTIONS DECLARATION ***************************/
 
@@ -168,7 +170,7 @@ void GenerateDemand(int multiplier){
         s1              = s1.substr(s1.find_last_of("\\/"), 100);
         string filename = "newdemand"+s1 + "NEW" + to_string(multiplier); 
 
-	ofstream fWriter(filename, ios::out);
+	WRITER fWriter(filename); // buffered (see writer_dm.cpp)
 
 	cout <<filename<< endl;
 	
@@ -180,9 +182,9 @@ void GenerateDemand(int multiplier){
 	double somma_base = 0.0;
 	double somma_nuovo = 0.0;
         //fWriter << filename<<endl;
-        fWriter << inp.nF <<" "<< inp.nC<< endl;
+        fWriter << inp.nF <<' '<< inp.nC<< '\n';
         for (int i = 0; i < inp.nF; i++){
-	  fWriter << inp.s[i] <<" "<< ((double)(multiplier))*((double)inp.f[i])<< endl;
+	  fWriter << inp.s[i] <<' '<< ((double)(multiplier))*((double)inp.f[i])<< '\n';
 	}
 
 
@@ -193,16 +195,15 @@ void GenerateDemand(int multiplier){
 	
         for (int j = 0; j < inp.nC; j++){
 	  double base_demand = (double)(inp.d[j]);
-		fWriter << base_demand<<" ";
+		fWriter << base_demand<<' ';
 		domanda_temp[j]=base_demand;
 	}
 
-        fWriter<< endl;
+        fWriter<< '\n';
 
-        for (int i = 0; i < inp.nF; i++){
-            for (int j = 0; j < inp.nC; j++) fWriter << inp.c[i][j]*domanda_temp[j]<<" ";
-		fWriter<< endl;
-        }
+        // cost matrix: rows formatted in parallel (see write_matrix())
+        write_matrix(fWriter, inp.nF, inp.nC,
+                     [&](int i, int j) { return inp.c[i][j]*domanda_temp[j]; });
 
     }
     // read Avella instances
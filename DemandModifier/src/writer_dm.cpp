@@ -0,0 +1,209 @@
+/***************************************************************************
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+/*! \file writer_dm.cpp
+  \brief Buffered writer of text files (solutions and instances).
+
+ * `ofstream <<` with `endl` flushes the stream at every row and formats every
+ * number through the locale machinery of iostream. A WRITER instead collects
+ * the text in a large buffer (4 MB by default), which is written with a
+ * single `fwrite` when full, and formats the numbers directly:
+ * - integers and doubles are converted with `to_chars`; doubles are written
+ *   in the shortest form that reads back to the same value (e.g., `0.1`,
+ *   `1234.5`), so that no digit is lost and no useless digit is written.
+ *   Without `to_chars` for doubles (older compilers), `%.17g` is used, which
+ *   also reads back exactly;
+ * - rows end with `'\n'`, never with a flush.
+ *
+ * Large matrices (e.g., the cost matrix of an instance) are written with
+ * write_matrix(): blocks of rows are formatted by several threads into their
+ * own buffers, and the blocks are then written in order.
+ */
+
+#include <cstdio>
+#include <cstring>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include <thread>
+#include <algorithm>
+#include <functional>
+#if __cplusplus >= 201703L
+#include <charconv>
+#endif
+
+#include "writer_dm.h"
+
+using namespace std;
+
+const int    MATRIX_BLOCK = 64;  //!< Rows formatted by a thread at a time (write_matrix())
+const size_t NUMBER_SIZE  = 32;  //!< Space reserved for one formatted number
+
+
+/// Format v in the shortest form that reads back to the same value; returns the length
+size_t format_double(char * out, double v)
+{
+#if defined(__cpp_lib_to_chars)
+    return to_chars(out, out + NUMBER_SIZE, v).ptr - out;
+#else
+    return snprintf(out, NUMBER_SIZE, "%.17g", v);
+#endif
+}
+
+/// Format an integer; returns the length
+size_t format_long(char * out, long v)
+{
+#if __cplusplus >= 201703L
+    return to_chars(out, out + NUMBER_SIZE, v).ptr - out;
+#else
+    return snprintf(out, NUMBER_SIZE, "%ld", v);
+#endif
+}
+
+WRITER::WRITER(const string & filename, size_t size) : size(max(size, 2*NUMBER_SIZE)), used(0)
+{
+    fp  = fopen(filename.c_str(), "w");
+    buf = new char[this->size];
+}
+
+WRITER::~WRITER()
+{
+    close();
+    delete [] buf;
+}
+
+void WRITER::flush()
+{
+    if (fp != NULL && used > 0)
+        fwrite(buf, 1, used, fp);
+    used = 0;
+}
+
+void WRITER::close()
+{
+    if (fp == NULL)
+        return;
+    flush();
+    fclose(fp);
+    fp = NULL;
+}
+
+void WRITER::write(const char * s, size_t n)
+{
+    if (used + n > size)
+    {
+        flush();
+        if (n > size) // larger than the buffer: written as it is
+        {
+            if (fp != NULL)
+                fwrite(s, 1, n, fp);
+            return;
+        }
+    }
+    memcpy(buf + used, s, n);
+    used += n;
+}
+
+WRITER & WRITER::operator<<(const char * s)
+{
+    write(s, strlen(s));
+    return *this;
+}
+
+WRITER & WRITER::operator<<(const string & s)
+{
+    write(s.data(), s.size());
+    return *this;
+}
+
+WRITER & WRITER::operator<<(char ch)
+{
+    if (used == size)
+        flush();
+    buf[used++] = ch;
+    return *this;
+}
+
+WRITER & WRITER::operator<<(int v)
+{
+    return *this << (long) v;
+}
+
+WRITER & WRITER::operator<<(long v)
+{
+    if (used + NUMBER_SIZE > size)
+        flush();
+    used += format_long(buf + used, v);
+    return *this;
+}
+
+WRITER & WRITER::operator<<(double v)
+{
+    if (used + NUMBER_SIZE > size)
+        flush();
+    used += format_double(buf + used, v);
+    return *this;
+}
+
+/// Write the matrix a(r,c) row by row, one row per line with a space after each value
+/**
+ * The rows are split in blocks of MATRIX_BLOCK rows, and each of nThreads
+ * threads (default: one per core) formats a block into its own buffer. When
+ * all threads are done, the blocks are written in order, and the next round
+ * starts. Only a few blocks are thus in memory, whatever the size of the
+ * matrix, and the file is the same as the one written by a single thread.
+ */
+void write_matrix(WRITER & w, int nRows, int nCols, const function<double(int, int)> & a,
+                  int nThreads)
+{
+    if (nThreads <= 0)
+        nThreads = max(1u, thread::hardware_concurrency());
+    int nBlocks = (nRows + MATRIX_BLOCK - 1)/MATRIX_BLOCK;
+    nThreads    = max(1, min(nThreads, nBlocks));
+
+    vector<vector<char>> text(nThreads);
+    vector<size_t> len(nThreads);
+    auto format = [&](int t, int block) {
+        int first = block*MATRIX_BLOCK;
+        int last  = min(nRows, first + MATRIX_BLOCK);
+        text[t].resize((size_t)(last - first)*(nCols*(NUMBER_SIZE + 1) + 1));
+        char * out = text[t].data();
+        for (int r = first; r < last; r++)
+        {
+            for (int c = 0; c < nCols; c++)
+            {
+                out += format_double(out, a(r, c));
+                *out++ = ' ';
+            }
+            *out++ = '\n';
+        }
+        len[t] = out - text[t].data();
+    };
+
+    for (int block = 0; block < nBlocks; block += nThreads)
+    {
+        int nRound = min(nThreads, nBlocks - block);
+        vector<thread> workers;
+        for (int t = 1; t < nRound; t++)
+            workers.push_back(thread(format, t, block + t));
+        format(0, block);
+        for (auto & worker : workers)
+            worker.join();
+        for (int t = 0; t < nRound; t++)
+            w.write(text[t].data(), len[t]);
+    }
+}
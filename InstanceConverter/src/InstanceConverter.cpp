@@ -0,0 +1,136 @@
+/***************************************************************************
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+/*! \mainpage Robust Capacitated Facility Location Problem
+
+  Description here.
+
+  \authors
+  \version v. 1.0.0
+  \date Begins: 25.05.18
+  \date Ends:
+
+  The project is compiled using a makefile and run via command line:
+  ~~~
+  make
+  ./bin/InstanceConverter -i data/cap41 -t 1 -o data/cap41.bin
+  ~~~
+
+  This tool converts a nominal instance (OR Library or Avella text format) into
+  the binary format read by all the other tools (rcflp, ScenarioEvaluator,
+  ScenarioGenerator and DemandModifier). Binary instances are recognized from
+  their header and are mapped in memory, so that many processes working on the
+  same instance share a single copy of the cost matrix.
+
+*/
+
+#include <chrono>
+#include <iostream>
+#include <iomanip>
+#include <cstdlib>
+#include <fstream>
+#include <cstring>
+#include <string>
+
+#include "options_ic.h"
+
+using namespace std;
+
+/****************** VARIABLES DECLARATION ***************************/
+char * _FILENAME;		//!< Instance name file
+char * _OUTNAME;		//!< Binary instance name file
+int fType;              //!< instance type (1-2)
+string instanceType;
+
+/// Structure used to define the instance data
+// NOTE: Change the same structure in the file inout.cpp !!!
+struct INSTANCE {
+    int nF;        //!< Number of facilities
+    int nC;        //!< Number of customers
+    double  *f;    //!< Fixed costs
+    double  *s;    //!< Capacity
+    double  *d;    //!< Demand
+    double **c;    //!< Allocation costs (rows of one contiguous block)
+    double  *cT;   //!< Allocation costs, customer-major (cT[j*nF+i])
+    double   totS; //!< Total supply
+    double   totD; //!< Total demand
+
+    int     nR;    //!< Number of constraints polyhedron uncertainty set
+    double  *h;    //!< Rhs of polyhedron definining support
+    int     *W;    //!< Matrix W in column major format
+    int *index;    //!< Index of column major format for w
+    int *start;    //!< Starting position for elements of column j
+
+};
+INSTANCE inp; //!< Instance data
+INSTANCE chk; //!< Instance read back from the binary file
+
+/****************** FUNCTIONS DECLARATION ***************************/
+int readProblemData(char * _FILENAME, int fType, INSTANCE & inp);
+int readBinaryProblemData(char * _FILENAME, INSTANCE & inp);
+int writeBinaryProblemData(char * _OUTNAME, int fType, INSTANCE & inp);
+void printOptions(char * _FILENAME, char * _OUTNAME, INSTANCE & inp);
+/****************** FUNCTIONS DECLARATION ***************************/
+
+/************************ main program ******************************/
+/// main program
+/************************ main program ******************************/
+int main(int argc, char *argv[])
+{
+    int err = parseOptions(argc, argv);
+    if (err != 0) exit(1);
+
+    string outName;
+    if (_OUTNAME == NULL)
+    {
+        outName  = string(_FILENAME) + ".bin";
+        _OUTNAME = (char *) outName.c_str();
+    }
+
+    auto start = chrono::system_clock::now();
+    readProblemData(_FILENAME, fType, inp);
+    double tText = chrono::duration<double>(chrono::system_clock::now()-start).count();
+    printOptions(_FILENAME, _OUTNAME, inp);
+
+    writeBinaryProblemData(_OUTNAME, fType, inp);
+
+    // read the file back and compare it with the text instance
+    start = chrono::system_clock::now();
+    readBinaryProblemData(_OUTNAME, chk);
+    double tBin = chrono::duration<double>(chrono::system_clock::now()-start).count();
+
+    bool same = (chk.nF == inp.nF && chk.nC == inp.nC);
+    same = same && memcmp(chk.f, inp.f, inp.nF*sizeof(double)) == 0;
+    same = same && memcmp(chk.s, inp.s, inp.nF*sizeof(double)) == 0;
+    same = same && memcmp(chk.d, inp.d, inp.nC*sizeof(double)) == 0;
+    for (int i = 0; same && i < inp.nF; i++)
+        same = memcmp(chk.c[i], inp.c[i], inp.nC*sizeof(double)) == 0;
+    if (!same)
+    {
+        cout << "ERROR : binary file '" << _OUTNAME << "' differs from the instance." << endl;
+        exit(1);
+    }
+
+    cout << "Binary instance written to disk. ('" << _OUTNAME << "')" << endl;
+    cout << " ..text parsing \t= " << setprecision(6) << tText << " s" << endl;
+    cout << " ..binary mapping \t= " << setprecision(6) << tBin << " s" << endl;
+
+    return 0;
+}
+/************************ main program ******************************/
+/// END main program
+/************************ main program ******************************/
@@ -0,0 +1,335 @@
+/***************************************************************************
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+/*! \file inout_ic.cpp
+  \brief Manage input/output.
+
+ * We manage here the following operations:
+ * * Read nominal instance from disk (both OR Library and Avella), exactly as
+ *   the other tools do.
+ * * Write the instance in binary format. See writeBinaryProblemData()
+ *
+
+*/
+
+#include <iostream>
+#include <iomanip>
+#include <cstdlib>
+#include <fstream>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+using namespace std;
+
+
+struct INSTANCE { /// See same data structure define in rcflp.cpp
+    int nF;
+    int nC;
+    double  *f;
+    double  *s;
+    double  *d;
+    double **c;
+    double  *cT;   // costs in customer-major format (cT[j*nF+i])
+    double   totS;
+    double   totD;
+
+    int nR;        // number of constraints polyhedron uncertainty set
+    double  *h;    // rhs of polyhedron definining support
+    int     *W;    // matrix W in column major format
+    int *index;    // index of column major format for w
+    int *start;    // starting position for elements of column j
+};
+
+extern string instanceType;
+
+
+/// Header of the binary instance format (see readBinaryProblemData())
+struct BINHEADER {
+    char   magic[8];   //!< "RCFLPBIN"
+    int    version;    //!< format version (currently 1)
+    int    fType;      //!< type of the text instance it was converted from (1-2)
+    int    nF;         //!< number of facilities
+    int    nC;         //!< number of customers
+    double totS;       //!< total supply
+    double totD;       //!< total demand
+    char   pad[24];    //!< padding to 64 bytes
+};
+const char BINMAGIC[8] = {'R','C','F','L','P','B','I','N'};
+const int  BINVERSION  = 1;
+const long BINALIGN    = 64; //!< every array starts on a 64-byte boundary
+
+/// Offsets (in bytes) of the arrays f, s, d and c in a binary instance file.
+/** The last element of `off` is the total size of the file. */
+void binary_offsets(int nF, int nC, long off[5])
+{
+    long n[4] = {(long)nF, (long)nF, (long)nC, (long)nF*(long)nC};
+    off[0] = sizeof(BINHEADER);
+    for (int k = 0; k < 4; k++)
+    {
+        off[k] = (off[k] + BINALIGN - 1)/BINALIGN*BINALIGN;
+        off[k+1] = off[k] + n[k]*(long)sizeof(double);
+    }
+}
+
+/// Check whether a file is an instance in binary format (by its magic number).
+bool isBinaryInstance(char * _FILENAME)
+{
+    char magic[8];
+    ifstream fReader(_FILENAME, ios::in | ios::binary);
+    if (!fReader || !fReader.read(magic, 8))
+        return false;
+    return memcmp(magic, BINMAGIC, 8) == 0;
+}
+
+/// Read an instance stored in binary format.
+/**
+ * The file is produced by the InstanceConverter tool and contains a
+ * BINHEADER followed by the arrays f[nF], s[nF], d[nC] and c[nF*nC]. The
+ * costs are stored row by row (facility-major) and are already the unit
+ * costs used internally, i.e., OR Library costs are divided by \f$d_j\f$.
+ *
+ * The file is mapped in memory (`mmap`) instead of being read, and the
+ * instance arrays point directly into the mapping. The mapping is private
+ * and read-only in practice: all the processes loading the same file share
+ * the pages of the page cache, and no copy of the cost matrix is made.
+ */
+int readBinaryProblemData(char * _FILENAME, INSTANCE & inp)
+{
+    int fd = open(_FILENAME, O_RDONLY);
+    if (fd < 0)
+    {
+        cout << "cannot open file " << _FILENAME << endl;
+        exit(1);
+    }
+    struct stat st;
+    fstat(fd, &st);
+    if ((size_t)st.st_size < sizeof(BINHEADER))
+    {
+        cout << "Binary instance " << _FILENAME << " is truncated." << endl;
+        exit(1);
+    }
+    // private mapping: pages are shared until (if ever) somebody writes them
+    char * base = (char *) mmap(NULL, st.st_size, PROT_READ | PROT_WRITE,
+                                MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED)
+    {
+        cout << "cannot map file " << _FILENAME << endl;
+        exit(1);
+    }
+
+    BINHEADER * head = (BINHEADER *) base;
+    long off[5];
+    binary_offsets(head->nF, head->nC, off);
+    if (memcmp(head->magic, BINMAGIC, 8) != 0 || head->version != BINVERSION
+        || head->nF <= 0 || head->nC <= 0 || off[4] > (long)st.st_size)
+    {
+        cout << "Binary instance " << _FILENAME << " is corrupted." << endl;
+        exit(1);
+    }
+
+    inp.nF   = head->nF;
+    inp.nC   = head->nC;
+    inp.totS = head->totS;
+    inp.totD = head->totD;
+    inp.f    = (double *) (base + off[0]);
+    inp.s    = (double *) (base + off[1]);
+    inp.d    = (double *) (base + off[2]);
+    inp.c    = new double*[inp.nF];
+    for (int i = 0; i < inp.nF; i++)
+        inp.c[i] = (double *) (base + off[3]) + (long)i*inp.nC;
+
+    return head->fType;
+}
+
+/// Allocate the cost matrix as a single aligned block.
+/**
+ * The costs are stored row by row (facility-major) in one contiguous buffer
+ * aligned to BINALIGN bytes, and `c[i]` points to the beginning of row `i`.
+ * Loops over \f$c_{ij}\f$ thus run over consecutive memory, and the layout
+ * is the same as the one used in the binary format.
+ */
+void allocate_costs(INSTANCE & inp)
+{
+    size_t bytes = ((size_t)inp.nF*inp.nC*sizeof(double) + BINALIGN - 1)/BINALIGN*BINALIGN;
+    double * buffer = (double *) aligned_alloc(BINALIGN, bytes);
+    inp.c = new double*[inp.nF];
+    for (int i = 0; i < inp.nF; i++)
+        inp.c[i] = buffer + (long)i*inp.nC;
+}
+
+/// Read benchmark instances
+/**
+ * Currently, two types of instances can be imported:
+ * type 1: OR Library
+ * type 2: Avella (Test Bed 1, Test Bed A. Test Bed B)
+ *
+ * Instances converted to the binary format (see readBinaryProblemData()) are
+ * recognized automatically and are mapped in memory instead of being parsed.
+ */
+int readProblemData(char * _FILENAME, int fType, INSTANCE & inp)
+{
+    inp.totS = 0.0;
+    inp.cT   = NULL;
+    inp.totD = 0.0;
+    // binary instances are recognized by their header, whatever the -t flag
+    if (isBinaryInstance(_FILENAME))
+    {
+        int binType = readBinaryProblemData(_FILENAME, inp);
+        if (binType != fType)
+            cout << "[** Binary instance converted from type " << binType
+                 << ", but -t " << fType << " was given]" << endl;
+        return 1;
+    }
+
+    ifstream fReader(_FILENAME, ios::in);
+    if (!fReader)
+    {
+        cout << "cannot open file " << _FILENAME << endl;
+        exit(1);
+    }
+    // read OR Library instances
+    if (fType == 1)
+    {
+        
+        fReader >> inp.nF >> inp.nC;
+        inp.s = new double[inp.nF];
+        inp.f = new double[inp.nF];
+        inp.d = new double[inp.nC];
+        allocate_costs(inp);
+
+        for (int i = 0; i < inp.nF; i++)
+        {
+            fReader >> inp.s[i] >> inp.f[i];
+            inp.totS += inp.s[i];
+        }
+
+        for (int j = 0; j < inp.nC; j++)
+        {
+            fReader >> inp.d[j];
+		//cout << "leggo " << j << " : " << inp.d[j] << endl;
+            inp.totD += inp.d[j];
+        }
+
+        for (int i = 0; i < inp.nF; i++)
+            for (int j = 0; j < inp.nC; j++)
+            {
+                fReader >> inp.c[i][j];
+                inp.c[i][j] /= inp.d[j];
+            }
+
+    }
+    // read Avella instances
+    else if (fType == 2)
+    {
+        fReader >> inp.nC >> inp.nF;
+        inp.f = new double[inp.nF];
+        inp.s = new double[inp.nF];
+        inp.d = new double[inp.nC];
+        allocate_costs(inp);
+        for (int j = 0; j < inp.nC; j++)
+        {
+            fReader >> inp.d[j];
+            inp.totD += inp.d[j];
+        }
+        for (int i = 0; i < inp.nF; i++)
+        {
+            fReader >> inp.s[i];
+            inp.totS += inp.s[i];
+        }
+        for (int i = 0; i < inp.nF; i++)
+            fReader >> inp.f[i];
+
+        for (int i = 0; i < inp.nF; i++)
+            for (int j = 0; j < inp.nC; j++)
+                fReader >> inp.c[i][j];
+    }
+    else
+        cout << "Problem type not defined (-t option). Use '-h' for help. " << endl;
+
+    fReader.close();
+
+    return 1;
+}
+
+/// Write the instance in binary format.
+/**
+ * The layout is the one read by readBinaryProblemData(): a BINHEADER,
+ * followed by f, s, d and c (facility-major), each array starting on a
+ * 64-byte boundary. Costs are written after the normalization done by
+ * readProblemData(), so the file can be mapped and used as it is.
+ */
+int writeBinaryProblemData(char * _OUTNAME, int fType, INSTANCE & inp)
+{
+    BINHEADER head;
+    memset(&head, 0, sizeof(head));
+    memcpy(head.magic, BINMAGIC, 8);
+    head.version = BINVERSION;
+    head.fType   = fType;
+    head.nF      = inp.nF;
+    head.nC      = inp.nC;
+    head.totS    = inp.totS;
+    head.totD    = inp.totD;
+
+    long off[5];
+    binary_offsets(inp.nF, inp.nC, off);
+
+    ofstream fWriter(_OUTNAME, ios::out | ios::binary);
+    if (!fWriter)
+    {
+        cout << "cannot open file " << _OUTNAME << endl;
+        exit(1);
+    }
+    char zeros[BINALIGN];
+    memset(zeros, 0, BINALIGN);
+
+    fWriter.write((char *) &head, sizeof(head));
+    fWriter.write(zeros, off[0] - sizeof(head));
+    fWriter.write((char *) inp.f, inp.nF*sizeof(double));
+    fWriter.write(zeros, off[1] - off[0] - inp.nF*sizeof(double));
+    fWriter.write((char *) inp.s, inp.nF*sizeof(double));
+    fWriter.write(zeros, off[2] - off[1] - inp.nF*sizeof(double));
+    fWriter.write((char *) inp.d, inp.nC*sizeof(double));
+    fWriter.write(zeros, off[3] - off[2] - inp.nC*sizeof(double));
+    for (int i = 0; i < inp.nF; i++)
+        fWriter.write((char *) inp.c[i], inp.nC*sizeof(double));
+
+    if (!fWriter)
+    {
+        cout << "error while writing file " << _OUTNAME << endl;
+        exit(1);
+    }
+    fWriter.close();
+
+    return 1;
+}
+
+void printOptions(char * _FILENAME, char * _OUTNAME, INSTANCE & inp)
+{
+   cout << "-------------------------------------" << endl;
+   cout << "- OPTIONS : " << endl;
+   cout << "-------------------------------------" << endl;
+   cout << "  DATA FILE      = " << _FILENAME        << endl;
+   cout << "  BINARY FILE    = " << _OUTNAME        << endl;
+   cout << "  Instance type  = " << instanceType << endl;
+   cout << "  Nr. Facilities = " << inp.nF << endl;
+   cout << "  Nr. Customers  = " << inp.nC << endl;
+   cout << "-------------------------------------" <<  endl << endl;   
+}
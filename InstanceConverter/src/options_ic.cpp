@@ -0,0 +1,112 @@
+/***************************************************************************
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+/*! \file options_ic.cpp
+  \brief Read options from command line.
+
+    Command line options are:
+
+    - **-h** : help (visualize the list of options)
+
+    - **-i** : text instance file
+
+    - **-t** : instance type:
+            -# orLibrary
+            -# Avella
+
+    - **-o** : binary output file (default: input file name + ".bin")
+*/
+
+#include <iostream>
+#include <cstdlib>
+
+using namespace std;
+
+extern char* _FILENAME; 	//!< name of the instance file
+extern char* _OUTNAME;  	//!< name of the binary file
+extern string instanceType;
+extern int fType;           //!< instance type (1-2)
+
+
+int parseOptions(int argc, char* argv[])
+{
+   bool setFile = false;
+   bool setType = false;
+
+   cout <<endl << "R-CLSP v1.0 " << endl;
+   if (argc == 1)
+   {
+      cout << "No options specified. Try -h " << endl;
+      return -1;
+   }  
+
+   int i = 0;
+   while (++i < argc)
+   {
+      const char *option = argv[i];
+      if (*option != '-')
+	 return i;
+      else if (*option == '\0')
+	 return i;
+      else if (*option == '-')
+      {
+	 switch (*++option)
+	 {
+	    case '\0':
+	       return i + 1;
+	    case 'i':
+	       _FILENAME = argv[i+1];
+	       setFile = true;
+	       i++;
+	       break;
+	    case 't':
+	       fType = atol(argv[i+1]);
+               setType = true;
+	       i++;
+	       break;
+	    case 'o':
+	       _OUTNAME = argv[i+1];
+	       i++;
+	       break;
+	    case 'h':
+	       cout << "OPTIONS :: " << endl;
+	       cout << "-i : problem instance file (text)" << endl;
+	       cout << "-t : instance type (1-OR Library; 2-Avella)" << endl;
+	       cout << "-o : binary output file (default: <instance>.bin)" << endl;
+	       cout << endl;
+	       return -1;
+	 }
+      }
+   }
+ 
+   if (setFile && setType)
+   {
+        if (fType == 1)
+            instanceType = "OR Library";
+        else if (fType == 2)
+            instanceType = "Avella";
+        else
+            instanceType = "***";
+
+        return 0;
+   }
+   else
+   {
+      cout <<"Options -i and -t are mandatory. Try ./InstanceConverter -h" << endl;
+      return -1;
+   }
+}
@@ -32,6 +32,27 @@
 
   This function generates new scenario instances based on a nominal instance 
 
+  With `-l`, the solution is evaluated against a whole list of scenarios in
+  one run (see batch_se.cpp):
+  ~~~
+  ./bin/ScenarioEvaluator -s solution.txt -t 1 -l 'scenarios/cap41_*.txt' -o evaluation.txt
+  ~~~
+
+  and with `-S` many solutions are compared on the same scenarios:
+  ~~~
+  ./bin/ScenarioEvaluator -S solutions/ -t 1 -l 'scenarios/cap41_*.txt' -o cross.txt
+  ~~~
+
+  With `-r 1` (multi-source) or `-r 2` (single-source), the demand of each
+  scenario is reallocated to the open facilities (see recourse_se.cpp).
+
+  With `-u`, the worst-case load of each open facility and the worst-case
+  cost of the solution are computed over the support of rcflp (see
+  oracle_se.cpp), e.g., for the budget support:
+  ~~~
+  ./bin/ScenarioEvaluator -i cap41.txt -s solution.txt -t 1 -u 2 -e 0.1 -B support/cap41.txt.budget
+  ~~~
+
 
 */
 
@@ -56,6 +77,7 @@ ILOSTLBEGIN
 #include <algorithm>
 #include <cstdlib>
 #include <sstream>
+#include <vector>
 
 /* #include "timer.h" */
 #include "options_se.h"
@@ -74,6 +96,15 @@ mt19937_64 gen(seed); //!< 64-bit Mersenne Twister by Matsumoto and Nishimura, 2
 char * _FILENAME;		//!< Instance name file
 char * _SOLNAME;		//!< Instance name file
 char * _OUTNAME;
+char * _LISTNAME;		//!< Scenario files to evaluate (NULL: only -i, see batch_se.cpp)
+char * _SOLLIST;		//!< Solution files of a cross evaluation (NULL: only -s)
+int nThreads;           //!< Threads of the evaluation of a list (0: all cores)
+int benchSize;          //!< Size of the benchmark of the evaluation kernels (0: none)
+int recourseMode;       //!< 0-Planned allocations; 1-Reallocation (MS); 2-Reallocation (SS)
+int support;            //!< Worst case over the support (0-No; 1-Box; 2-Budget; 3-Ellipsoidal)
+double _epsilon;        //!< Relative deviation of the demand in the support
+double _Omega;          //!< Radius of the ellipsoidal support
+char * _BUDGETNAME;		//!< Sets and budgets of the budget support (see oracle_se.cpp)
 int fType;              //!< instance type (1-4)
 string instanceType;
 
@@ -85,7 +116,8 @@ struct INSTANCE {
     double  *f;    //!< Fixed costs
     double  *s;    //!< Capacity
     double  *d;    //!< Demand
-    double **c;    //!< Allocation costs
+    double **c;    //!< Allocation costs (rows of one contiguous block)
+    double  *cT;   //!< Allocation costs, customer-major (cT[j*nF+i])
     double   totS; //!< Total supply
     double   totD; //!< Total demand
 
@@ -99,10 +131,17 @@ struct INSTANCE {
 INSTANCE inp; //!< Instance data
 
 /// Optimal solution and obj function value
+/**
+ * Allocations in customer-major sparse format, as in rcflp: customer
+ * \f$j\f$ is served by facilities `xFac[k]`, with fractions `xVal[k]`,
+ * for \f$k\f$ = `xBeg[j]`, ..., `xBeg[j+1]-1`.
+ */
 struct SOLUTION {
     int nOpen;
     int  *ySol;
-    double **xSol;
+    vector<int>    xBeg;  //!< first allocation of each customer (nC+1 elements)
+    vector<int>    xFac;  //!< facility of each allocation
+    vector<double> xVal;  //!< fraction of the demand of each allocation
     double zStar;
     IloAlgorithm::Status zStatus;
     IloNum startTime;
@@ -130,10 +169,16 @@ int timeLimit;
 /****************** FUNCTIONS DECLARATION ***************************/
 int readProblemData(char * _FILENAME, int fType, INSTANCE & inp);
 int readSolution(char * _SOLNAME, SOLUTION & opt, INSTANCE & inp);
-void printOptions(char * _FILENAME, char * _SOLNAME, INSTANCE inp, int timeLimit);
+void printOptions(char * _FILENAME, char * _SOLNAME, INSTANCE & inp, int timeLimit);
 double ComputeValue(SOLUTION & opt, INSTANCE & inp);
 //double ComputeInfeasibility(SOLUTION & opt, INSTANCE & inp);
-void printSolution(char * _FILENAME, INSTANCE inp, SOLUTION opt, bool toDisk,int fullOutput);
+void printSolution(char * _FILENAME, INSTANCE & inp, SOLUTION & opt, bool toDisk,int fullOutput);
+int evaluate_batch(const char * _LISTNAME, char * _SOLNAME, char * _OUTNAME, SOLUTION & opt,
+                   INSTANCE & inp, int nThreads);
+int evaluate_benchmark(int n);
+int evaluate_cross(const char * _LISTNAME, const char * _SOLLIST, char * _OUTNAME, int nThreads);
+int evaluate_worst_case(INSTANCE & inp, SOLUTION & opt, int support, double epsilon,
+                        double Omega, const char * _BUDGETNAME, char * _OUTNAME, int nThreads);
 /****************** FUNCTIONS DECLARATION ***************************/
 
 /************************ main program ******************************/
@@ -145,8 +190,35 @@ int main(int argc, char *argv[])
 	int err = parseOptions(argc, argv);
 	if (err != 0) exit(1);
 
+	if (benchSize > 0) // throughput of the evaluation kernels (see batch_se.cpp)
+		return evaluate_benchmark(benchSize);
+	if (_LISTNAME != NULL && _SOLLIST != NULL) // many solutions, many scenarios
+		return evaluate_cross(_LISTNAME, _SOLLIST, _OUTNAME, nThreads);
+	if (_LISTNAME != NULL) // one solution, many scenarios (see batch_se.cpp)
+	{
+		if (_SOLNAME == NULL)
+		{
+			cout << "Option -s is mandatory with -l. Try -h" << endl;
+			exit(1);
+		}
+		if (readSolution(_SOLNAME, opt, inp) == 0)
+			exit(1);
+		return evaluate_batch(_LISTNAME, _SOLNAME, _OUTNAME, opt, inp, nThreads);
+	}
+
 	readProblemData(_FILENAME, fType, inp);
-	readSolution(_SOLNAME, opt, inp);
+	int nF = inp.nF, nC = inp.nC;
+	if (readSolution(_SOLNAME, opt, inp) == 0)
+		exit(1);
+	if (inp.nF != nF || inp.nC != nC)
+	{
+		cout << "Solution " << _SOLNAME << " has size " << inp.nF << " x " << inp.nC
+		     << ", while the instance has size " << nF << " x " << nC << endl;
+		exit(1);
+	}
+	if (support > 0) // worst case over the support (see oracle_se.cpp)
+		return evaluate_worst_case(inp, opt, support, _epsilon, _Omega, _BUDGETNAME, _OUTNAME,
+		                           nThreads);
 
 	printOptions(_FILENAME,  _SOLNAME, inp, timeLimit);
 	printSolution(_FILENAME,inp, opt, 0,0);
@@ -184,14 +256,14 @@ double ComputeValue(SOLUTION & opt, INSTANCE & inp){
 	for (int i = 0 ; i < inp.nF ; i++) const_part+= opt.ySol[i] * inp.f[i];
 
 
-	for (int i = 0; i < inp.nF; i++) for (int j = 0; j < inp.nC; j++) variable_part += opt.xSol[i][j]* inp.d[j]*inp.c[i][j];
+	for (int j = 0; j < inp.nC; j++) for (int k = opt.xBeg[j]; k < opt.xBeg[j+1]; k++) variable_part += opt.xVal[k]* inp.d[j]*inp.c[opt.xFac[k]][j];
 
 	cout << setprecision(15)<< const_part << " + " << variable_part << " = " << const_part + variable_part << endl;
 
 	double * infeasibility_vector= new double[inp.nF];
 	double infeasibility_max = 0; 
 	for (int i = 0 ; i < inp.nF ; i++) infeasibility_vector[i] = opt.ySol[i] * inp.s[i];
-	for (int i = 0; i < inp.nF; i++) for (int j = 0; j < inp.nC; j++) infeasibility_vector[i] -= opt.xSol[i][j]* inp.d[j];
+	for (int j = 0; j < inp.nC; j++) for (int k = opt.xBeg[j]; k < opt.xBeg[j+1]; k++) infeasibility_vector[opt.xFac[k]] -= opt.xVal[k]* inp.d[j];
 	
 
 
@@ -221,7 +293,7 @@ double ComputeValue(SOLUTION & opt, INSTANCE & inp){
 
 
 
-void printSolution(char * _FILENAME, INSTANCE inp, SOLUTION opt, bool toDisk, 
+void printSolution(char * _FILENAME, INSTANCE & inp, SOLUTION & opt, bool toDisk, 
 int fullOutput)
 {
     cout << endl << "** SOLUTION **" << endl;
@@ -245,15 +317,11 @@ int fullOutput)
         if (fullOutput >= 2)
         {
             cout << "Allocation variables : " << endl;
-            for (int i = 0; i < inp.nF; i++)
-                for (int j = 0; j < inp.nC; j++)
-                    if (opt.xSol[i][j] >= EPSI)
-                        cout << "x(" << i << "," << j << ") = " << setprecision(3) 
-                        << opt.xSol[i][j] << endl;
-	    for (int i = 0; i < inp.nF; i++){
-		for (int j = 0; j < inp.nC; j++) cout << setprecision(3) << opt.xSol[i][j] << " ";
-		cout << endl;
-	    }
+            for (int j = 0; j < inp.nC; j++)
+                for (int k = opt.xBeg[j]; k < opt.xBeg[j+1]; k++)
+                    if (opt.xVal[k] >= EPSI)
+                        cout << "x(" << opt.xFac[k] << "," << j << ") = " << setprecision(3) 
+                        << opt.xVal[k] << endl;
 
         }
     }
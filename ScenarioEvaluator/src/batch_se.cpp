@@ -0,0 +1,906 @@
+/***************************************************************************
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+/*! \file batch_se.cpp
+  \brief Evaluation of one or many solutions against many scenarios (flags -l and -S).
+
+ * With **-l** `scenarios`, the solution given with -s is read once and
+ * evaluated against every scenario of the list, where `scenarios` is:
+ * - a directory: all the files in it, in alphabetical order;
+ * - a pattern with `*`, `?` or `[` (in quotes, so that the shell does not
+ *   expand it), e.g., `'scenarios/cap41_*.txt'`;
+ * - otherwise, a text file with one scenario file per row (empty rows and
+ *   rows starting with '#' are skipped).
+ *
+ * The scenarios are instance files in the format given by -t (e.g., the
+ * ones written by ScenarioGenerator), or in binary format. They are split
+ * among **-n** threads (default: one per core). A scenario is scanned once,
+ * and only the costs of the allocations of the solution are converted to
+ * numbers: the other ones are skipped, and the cost matrix is never stored.
+ * The values are computed as in ComputeValue(), in the same order, so each
+ * row is the one a separate run on the same scenario would write.
+ *
+ * The table (-o, default `evaluation.txt`) has one row per scenario,
+ * ~~~
+ * scenario;solution;fixed cost;allocation cost;total infeasibility;max infeasibility
+ * ~~~
+ * followed by the rows `mean`, `stddev`, `min`, `median`, `q95` and `max`,
+ * with the statistics of each column over the scenarios. The infeasibility
+ * is the capacity shortage of the open facilities (zero or negative total,
+ * as in ComputeValue()).
+ *
+ * With **-S** `solutions` (a directory, pattern or list, as for -l) instead
+ * of -s, all the solutions (e.g., the nominal, box, budget and ellipsoidal
+ * ones) are evaluated against the same scenarios, each of which is read
+ * only once (see evaluate_cross()). The output is:
+ * - `out.cost` and `out.infeas`: the matrices of the total cost and of the
+ *   total infeasibility, with one row per solution and one column per
+ *   scenario (the first row has the names of the scenarios);
+ * - `out`: one row per solution with the mean, standard deviation, 95th
+ *   percentile and worst cost, the mean and worst capacity shortage, and
+ *   the violation probability, i.e., the fraction of scenarios with a
+ *   shortage.
+ *
+ * With **-r**, the open facilities of the solutions are kept, and the demand
+ * of each scenario is reallocated to them (see recourse_se.cpp): the
+ * allocation cost is then the recourse cost, and the infeasibility columns
+ * are minus the unmet demand and the largest unmet demand of a customer
+ * (the shortage of the summary of -S is the unmet demand).
+ *
+ * The solutions are evaluated on blocks of SCENARIO_BLOCK scenarios at a
+ * time (see evaluate_block()), whose inner loops run over the scenarios and
+ * are vectorized. With **-b** `n`, the throughput of this kernel and of the
+ * one-scenario kernel is measured on a random instance with
+ * \f$n_F = n_C = n\f$ (see evaluate_benchmark()).
+ */
+
+#include <ilcplex/ilocplex.h>
+ILOSTLBEGIN
+
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cctype>
+#include <cmath>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <random>
+#include <glob.h>
+#include <dirent.h>
+#include <sys/stat.h>
+
+using namespace std;
+
+
+struct INSTANCE { /// See same data structure define in ScenarioEvaluator.cpp
+    int nF;
+    int nC;
+    double  *f;
+    double  *s;
+    double  *d;
+    double **c;
+    double  *cT;   // costs in customer-major format (cT[j*nF+i])
+    double   totS;
+    double   totD;
+
+    int nR;        // number of constraints polyhedron uncertainty set
+    double  *h;    // rhs of polyhedron definining support
+    int     *W;    // matrix W in column major format
+    int *index;    // index of column major format for w
+    int *start;    // starting position for elements of column j
+};
+
+struct SOLUTION { /// See same data structure define in ScenarioEvaluator.cpp
+    int nOpen;
+    int  *ySol;
+    vector<int>    xBeg;  // customer-major sparse allocations (see ScenarioEvaluator.cpp)
+    vector<int>    xFac;
+    vector<double> xVal;
+    double zStar;
+    IloAlgorithm::Status zStatus;
+    IloNum startTime;
+    IloNum cpuTime;
+};
+
+/// Header of the binary instance format (see same data structure in inout_se.cpp)
+struct BINHEADER {
+    char   magic[8];
+    int    version;
+    int    fType;
+    int    nF;
+    int    nC;
+    double totS;
+    double totD;
+    char   pad[24];
+};
+
+extern int fType;
+extern int recourseMode;
+const double EPSI = 0.00001;
+const int SCENARIO_BLOCK = 16; //!< Scenarios read and evaluated at a time by a thread
+
+void binary_offsets(int nF, int nC, long off[5]);
+int readSolution(char * _SOLNAME, SOLUTION & opt, INSTANCE & inp);
+double recourse_transportation(vector<int> & open, int nC, const double * s, const double * d,
+                               vector<const double *> & cost, double & unmet, double & unmetMax);
+double recourse_assignment(vector<int> & open, int nC, const double * s, const double * d,
+                           vector<const double *> & cost, vector<int> & planned,
+                           double & unmet, double & unmetMax);
+
+/// Value of the solution on one scenario (a row of the table)
+struct EVALUATION {
+    bool   ok;        //!< false if the scenario could not be read
+    double fixed;     //!< fixed cost of the open facilities
+    double alloc;     //!< allocation cost
+    double infTot;    //!< total infeasibility (sum of the negative slacks)
+    double infMax;    //!< largest capacity shortage
+};
+
+
+/// Scenario files given with -l (see the description of the file)
+vector<string> scenario_files(const char * _LISTNAME)
+{
+    vector<string> files;
+    struct stat st;
+    if (stat(_LISTNAME, &st) == 0 && S_ISDIR(st.st_mode))
+    {
+        DIR * dir = opendir(_LISTNAME);
+        struct dirent * entry;
+        while (dir != NULL && (entry = readdir(dir)) != NULL)
+        {
+            string name = string(_LISTNAME) + "/" + entry->d_name;
+            if (entry->d_name[0] != '.' && stat(name.c_str(), &st) == 0 && S_ISREG(st.st_mode))
+                files.push_back(name);
+        }
+        if (dir != NULL)
+            closedir(dir);
+        sort(files.begin(), files.end());
+    }
+    else if (strpbrk(_LISTNAME, "*?[") != NULL)
+    {
+        glob_t g;
+        if (glob(_LISTNAME, 0, NULL, &g) == 0) // glob() sorts the names
+            for (size_t k = 0; k < g.gl_pathc; k++)
+                files.push_back(g.gl_pathv[k]);
+        globfree(&g);
+    }
+    else
+    {
+        ifstream fReader(_LISTNAME, ios::in);
+        if (!fReader)
+        {
+            cout << "cannot open file " << _LISTNAME << endl;
+            exit(1);
+        }
+        string line;
+        while (getline(fReader, line))
+        {
+            line.erase(line.find_last_not_of(" \t\r") + 1);
+            if (!line.empty() && line[0] != '#')
+                files.push_back(line);
+        }
+    }
+    return files;
+}
+
+/// Read a whole file in buf (null-terminated). Returns false if it cannot be read.
+bool read_file(const string & name, vector<char> & buf)
+{
+    FILE * fp = fopen(name.c_str(), "rb");
+    if (fp == NULL)
+        return false;
+    fseek(fp, 0, SEEK_END);
+    long size = ftell(fp);
+    fseek(fp, 0, SEEK_SET);
+    buf.resize(size + 1);
+    size_t n = fread(buf.data(), 1, size, fp);
+    fclose(fp);
+    buf[n] = '\0';
+    return (long) n == size;
+}
+
+/// Tokens of a text instance: numbers are converted only when they are needed
+struct SCANNER {
+    char * p;
+    bool   ok;
+
+    double next()
+    {
+        char * end;
+        double v = strtod(p, &end);
+        ok = ok && end != p;
+        p = end;
+        return v;
+    }
+    void skip()
+    {
+        while (isspace((unsigned char) *p))
+            p++;
+        ok = ok && *p != '\0';
+        while (*p != '\0' && !isspace((unsigned char) *p))
+            p++;
+    }
+};
+
+/// Data of one scenario needed by the evaluations
+/**
+ * Only the costs of the positions `pos` (\f$i n_C + j\f$, increasing) are
+ * kept: `cost[t]` is the unit cost \f$c_{ij}\f$ of position `pos[t]`.
+ */
+struct SCENARIO {
+    bool           ok;    //!< false if the file could not be read or does not match
+    vector<double> s;
+    vector<double> f;
+    vector<double> d;
+    vector<double> cost;
+};
+
+/// Read the scenario file name (text or binary); only the costs of pos are kept
+void read_scenario(const string & name, int nF, int nC, const vector<long> & pos,
+                   vector<char> & buf, SCENARIO & sc)
+{
+    sc.ok = false;
+    if (!read_file(name, buf))
+        return;
+    sc.s.resize(nF);
+    sc.f.resize(nF);
+    sc.d.resize(nC);
+    sc.cost.resize(pos.size());
+
+    BINHEADER * head = (BINHEADER *) buf.data();
+    if (buf.size() > sizeof(BINHEADER) && memcmp(head->magic, "RCFLPBIN", 8) == 0)
+    {
+        long off[5];
+        binary_offsets(head->nF, head->nC, off);
+        if (head->nF != nF || head->nC != nC || off[4] > (long) buf.size() - 1)
+            return;
+        const double * base = (const double *) buf.data();
+        copy(base + off[1]/8, base + off[1]/8 + nF, sc.s.begin());
+        copy(base + off[0]/8, base + off[0]/8 + nF, sc.f.begin());
+        copy(base + off[2]/8, base + off[2]/8 + nC, sc.d.begin());
+        for (unsigned t = 0; t < pos.size(); t++)
+            sc.cost[t] = base[off[3]/8 + pos[t]];
+        sc.ok = true;
+        return;
+    }
+
+    SCANNER in = {buf.data(), true};
+    int nRows = (int) in.next(), nCols = (int) in.next();
+    if (fType == 1) // OR Library: nF nC, (s f) by facility, d, total costs c_ij d_j
+    {
+        if (nRows != nF || nCols != nC)
+            return;
+        for (int i = 0; i < nF; i++)
+        {
+            sc.s[i] = in.next();
+            sc.f[i] = in.next();
+        }
+        for (int j = 0; j < nC; j++)
+            sc.d[j] = in.next();
+    }
+    else if (fType == 2) // Avella: nC nF, d, s, f, unit costs c_ij
+    {
+        if (nRows != nC || nCols != nF)
+            return;
+        for (int j = 0; j < nC; j++)
+            sc.d[j] = in.next();
+        for (int i = 0; i < nF; i++)
+            sc.s[i] = in.next();
+        for (int i = 0; i < nF; i++)
+            sc.f[i] = in.next();
+    }
+    else
+        return;
+
+    long next = 0; // position of the next cost in the file
+    for (unsigned t = 0; t < pos.size(); t++)
+    {
+        for (; next < pos[t]; next++)
+            in.skip();
+        sc.cost[t] = in.next();
+        if (fType == 1) // as in readProblemData()
+            sc.cost[t] /= sc.d[pos[t] % nC];
+        next++;
+    }
+    sc.ok = in.ok;
+}
+
+/// Value of the solution on the scenario (one scenario at a time, see evaluate_block())
+/**
+ * The cost of allocation `k` of the solution is `sc.cost[at[k]]`. The sums
+ * are the ones of ComputeValue(), in the same order.
+ */
+void evaluate(SOLUTION & opt, int nF, int nC, SCENARIO & sc, const vector<int> & at,
+              vector<double> & slack, EVALUATION & ev)
+{
+    ev.ok = sc.ok;
+    if (!sc.ok)
+        return;
+    ev.fixed = 0.0;
+    ev.alloc = 0.0;
+    for (int i = 0; i < nF; i++)
+        ev.fixed += opt.ySol[i] * sc.f[i];
+    for (int j = 0; j < nC; j++)
+        for (int k = opt.xBeg[j]; k < opt.xBeg[j+1]; k++)
+            ev.alloc += opt.xVal[k]*sc.d[j]*sc.cost[at[k]];
+
+    slack.resize(nF);
+    for (int i = 0; i < nF; i++)
+        slack[i] = opt.ySol[i] * sc.s[i];
+    for (int j = 0; j < nC; j++)
+        for (int k = opt.xBeg[j]; k < opt.xBeg[j+1]; k++)
+            slack[opt.xFac[k]] -= opt.xVal[k]*sc.d[j];
+    ev.infTot = 0.0;
+    ev.infMax = 0.0;
+    for (int i = 0; i < nF; i++)
+    {
+        ev.infTot += min(0.0, slack[i]);
+        ev.infMax  = max(ev.infMax, -min(0.0, slack[i]));
+    }
+}
+
+/// Data of SCENARIO_BLOCK scenarios, scenario index innermost (see evaluate_block())
+/**
+ * Element \f$(r, b)\f$ of each array is at `r*SCENARIO_BLOCK + b`, i.e., the
+ * values of row \f$r\f$ (a facility, a customer or a position of the
+ * costs) in the scenarios of the block are contiguous. Missing scenarios of
+ * the last block are zeros.
+ */
+struct BLOCK {
+    int            n;     //!< Scenarios in the block
+    bool           ok[SCENARIO_BLOCK];
+    vector<double> s;     //!< nF x SCENARIO_BLOCK
+    vector<double> f;     //!< nF x SCENARIO_BLOCK
+    vector<double> d;     //!< nC x SCENARIO_BLOCK
+    vector<double> cost;  //!< positions x SCENARIO_BLOCK
+};
+
+/// Store the scenarios sc[0], ..., sc[n-1] in blk
+void pack_block(vector<SCENARIO> & sc, int n, int nF, int nC, int nPos, BLOCK & blk)
+{
+    const int B = SCENARIO_BLOCK;
+    blk.n = n;
+    blk.s.assign((size_t) nF*B, 0.0);
+    blk.f.assign((size_t) nF*B, 0.0);
+    blk.d.assign((size_t) nC*B, 0.0);
+    blk.cost.assign((size_t) nPos*B, 0.0);
+    for (int b = 0; b < B; b++)
+    {
+        blk.ok[b] = b < n && sc[b].ok;
+        if (!blk.ok[b])
+            continue;
+        for (int i = 0; i < nF; i++)
+        {
+            blk.s[i*B + b] = sc[b].s[i];
+            blk.f[i*B + b] = sc[b].f[i];
+        }
+        for (int j = 0; j < nC; j++)
+            blk.d[j*B + b] = sc[b].d[j];
+        for (int t = 0; t < nPos; t++)
+            blk.cost[(size_t) t*B + b] = sc[b].cost[t];
+    }
+}
+
+/// Value of the solution on the scenarios of a block (ev[0], ..., ev[blk.n-1])
+/**
+ * Same values as evaluate() on each scenario, computed for the whole block
+ * at once: every inner loop runs over the SCENARIO_BLOCK scenarios, on
+ * contiguous data and with a constant trip count, and is vectorized by the
+ * compiler. The loads of the facilities are the product of the allocations
+ * (sparse, \f$n_F \times n_C\f$) and of the demands of the block
+ * (\f$n_C \times\f$ SCENARIO_BLOCK), i.e., a small matrix-matrix product.
+ * The sums of each scenario are done in the order of ComputeValue().
+ */
+void evaluate_block(SOLUTION & opt, int nF, int nC, const vector<int> & at, BLOCK & blk,
+                    vector<double> & load, EVALUATION * ev)
+{
+    const int B = SCENARIO_BLOCK;
+    double fixed[B] = {}, alloc[B] = {}, infTot[B] = {}, infMax[B] = {};
+    load.resize((size_t) nF*B);
+
+    for (int i = 0; i < nF; i++)
+    {
+        const double * f = &blk.f[i*B];
+        const double * s = &blk.s[i*B];
+        double * l = &load[i*B];
+        double y = opt.ySol[i];
+        for (int b = 0; b < B; b++)
+        {
+            fixed[b] += y*f[b];
+            l[b]      = y*s[b];
+        }
+    }
+    for (int j = 0; j < nC; j++)
+    {
+        const double * d = &blk.d[j*B];
+        for (int k = opt.xBeg[j]; k < opt.xBeg[j+1]; k++)
+        {
+            const double * c = &blk.cost[(size_t) at[k]*B];
+            double * l = &load[opt.xFac[k]*B];
+            double x = opt.xVal[k];
+            for (int b = 0; b < B; b++)
+            {
+                alloc[b] += x*d[b]*c[b];
+                l[b]     -= x*d[b];
+            }
+        }
+    }
+    for (int i = 0; i < nF; i++)
+    {
+        const double * l = &load[i*B];
+        for (int b = 0; b < B; b++)
+        {
+            infTot[b] += min(0.0, l[b]);
+            infMax[b]  = max(infMax[b], -min(0.0, l[b]));
+        }
+    }
+    for (int b = 0; b < blk.n; b++)
+        ev[b] = {blk.ok[b], fixed[b], alloc[b], infTot[b], infMax[b]};
+}
+
+/// Value of the solution on the scenario, with the demand reallocated to its open facilities (-r)
+/**
+ * The fixed cost is the one of evaluate(). The allocation cost is the one
+ * of the reallocation (see recourse_se.cpp), `infTot` is minus the unmet
+ * demand and `infMax` is the largest unmet demand of a customer.
+ */
+void evaluate_recourse(SOLUTION & opt, int nF, int nC, SCENARIO & sc, vector<long> & pos,
+                       EVALUATION & ev)
+{
+    ev.ok = sc.ok;
+    if (!sc.ok)
+        return;
+    vector<int> open, index(nF, -1);
+    vector<const double *> cost;
+    ev.fixed = 0.0;
+    for (int i = 0; i < nF; i++)
+    {
+        ev.fixed += opt.ySol[i] * sc.f[i];
+        if (opt.ySol[i] != 1)
+            continue;
+        index[i] = open.size();
+        open.push_back(i);
+        cost.push_back(&sc.cost[lower_bound(pos.begin(), pos.end(), (long) i*nC) - pos.begin()]);
+    }
+
+    double unmet, unmetMax;
+    if (recourseMode == 1)
+        ev.alloc = recourse_transportation(open, nC, sc.s.data(), sc.d.data(), cost, unmet,
+                                           unmetMax);
+    else
+    {
+        vector<int> planned(nC, -1); // open facility with the largest share of the customer
+        for (int j = 0; j < nC; j++)
+        {
+            int best = -1;
+            for (int k = opt.xBeg[j]; k < opt.xBeg[j+1]; k++)
+                if (index[opt.xFac[k]] >= 0 && (best < 0 || opt.xVal[k] > opt.xVal[best]))
+                    best = k;
+            if (best >= 0)
+                planned[j] = index[opt.xFac[best]];
+        }
+        ev.alloc = recourse_assignment(open, nC, sc.s.data(), sc.d.data(), cost, planned, unmet,
+                                       unmetMax);
+    }
+    ev.infTot = -unmet;
+    ev.infMax = unmetMax;
+}
+
+/// Positions (i*nC + j) of the allocations of all the solutions, and of each allocation
+/**
+ * `pos` is the sorted union of the positions, i.e., the order of the costs
+ * in a scenario file, and allocation `k` of solution `s` is at position
+ * `pos[at[s][k]]`. With recourse (-r), `pos` also has all the positions of
+ * the open facilities.
+ */
+void allocation_positions(vector<SOLUTION> & sols, int nF, int nC, vector<long> & pos,
+                          vector<vector<int>> & at)
+{
+    pos.clear();
+    for (SOLUTION & opt : sols)
+        for (int j = 0; j < nC; j++)
+            for (int k = opt.xBeg[j]; k < opt.xBeg[j+1]; k++)
+                pos.push_back((long) opt.xFac[k]*nC + j);
+    if (recourseMode > 0) // any customer can be moved to any open facility (see recourse_se.cpp)
+        for (SOLUTION & opt : sols)
+            for (int i = 0; i < nF; i++)
+                for (int j = 0; opt.ySol[i] == 1 && j < nC; j++)
+                    pos.push_back((long) i*nC + j);
+    sort(pos.begin(), pos.end());
+    pos.erase(unique(pos.begin(), pos.end()), pos.end());
+
+    at.assign(sols.size(), vector<int>());
+    for (unsigned n = 0; n < sols.size(); n++)
+    {
+        SOLUTION & opt = sols[n];
+        at[n].resize(opt.xFac.size());
+        for (int j = 0; j < nC; j++)
+            for (int k = opt.xBeg[j]; k < opt.xBeg[j+1]; k++)
+                at[n][k] = lower_bound(pos.begin(), pos.end(), (long) opt.xFac[k]*nC + j)
+                           - pos.begin();
+    }
+}
+
+/// Evaluate every solution on every scenario file (evals[k*nS + n]: solution k, scenario n)
+/**
+ * The scenarios are split in blocks of SCENARIO_BLOCK, taken in turn by
+ * nThreads threads. A thread reads a block and then evaluates every
+ * solution on the whole block with evaluate_block(), so the data of a
+ * solution is used on the whole block while it is in cache (or, with
+ * recourse, on each scenario with evaluate_recourse()). Returns the number
+ * of threads used.
+ */
+int evaluate_scenarios(vector<string> & files, vector<SOLUTION> & sols, vector<long> & pos,
+                       vector<vector<int>> & at, int nF, int nC, int nThreads,
+                       vector<EVALUATION> & evals)
+{
+    int nS = files.size(), nK = sols.size();
+    int nBlocks = (nS + SCENARIO_BLOCK - 1)/SCENARIO_BLOCK;
+    if (nThreads <= 0)
+        nThreads = max(1u, thread::hardware_concurrency());
+    nThreads = max(1, min(nThreads, nBlocks));
+
+    evals.resize((size_t) nK*nS);
+    atomic<int> next(0);
+    auto work = [&]() {
+        vector<char> buf; // reused for all the scenarios of the thread
+        vector<double> load;
+        vector<SCENARIO> sc(SCENARIO_BLOCK);
+        BLOCK blk;
+        for (int b = next++; b < nBlocks; b = next++)
+        {
+            int first = b*SCENARIO_BLOCK, last = min(nS, first + SCENARIO_BLOCK);
+            for (int n = first; n < last; n++)
+                read_scenario(files[n], nF, nC, pos, buf, sc[n - first]);
+            if (recourseMode > 0) // one scenario at a time (see recourse_se.cpp)
+            {
+                for (int k = 0; k < nK; k++)
+                    for (int n = first; n < last; n++)
+                        evaluate_recourse(sols[k], nF, nC, sc[n - first], pos,
+                                          evals[(size_t) k*nS + n]);
+                continue;
+            }
+            pack_block(sc, last - first, nF, nC, pos.size(), blk);
+            for (int k = 0; k < nK; k++)
+                evaluate_block(sols[k], nF, nC, at[k], blk, load, &evals[(size_t) k*nS + first]);
+        }
+    };
+    vector<thread> workers;
+    for (int t = 1; t < nThreads; t++)
+        workers.push_back(thread(work));
+    work();
+    for (auto & worker : workers)
+        worker.join();
+    return nThreads;
+}
+
+/// Statistics of the column col of the evaluations (mean, stddev, min, median, q95, max)
+vector<double> column_statistics(vector<EVALUATION> & evals, double EVALUATION::* col)
+{
+    vector<double> v;
+    for (EVALUATION & ev : evals)
+        if (ev.ok)
+            v.push_back(ev.*col);
+    if (v.empty())
+        return vector<double>(6, 0.0);
+    sort(v.begin(), v.end());
+    double mean = 0.0, var = 0.0;
+    for (double x : v)
+        mean += x;
+    mean /= v.size();
+    for (double x : v)
+        var += (x - mean)*(x - mean);
+    auto quantile = [&](double q) { return v[(size_t) floor(q*(v.size() - 1) + 0.5)]; };
+    return {mean, sqrt(var/max<size_t>(1, v.size() - 1)), v.front(), quantile(0.5),
+            quantile(0.95), v.back()};
+}
+
+/// Evaluate the solution against all the scenarios of the list (flag -l)
+int evaluate_batch(const char * _LISTNAME, char * _SOLNAME, char * _OUTNAME, SOLUTION & opt,
+                   INSTANCE & inp, int nThreads)
+{
+    vector<string> files = scenario_files(_LISTNAME);
+    if (files.empty())
+    {
+        cout << "No scenario files in " << _LISTNAME << endl;
+        return 1;
+    }
+    vector<SOLUTION> sols(1, opt);
+    vector<long> pos;
+    vector<vector<int>> at;
+    allocation_positions(sols, inp.nF, inp.nC, pos, at);
+
+    vector<EVALUATION> evals;
+    nThreads = evaluate_scenarios(files, sols, pos, at, inp.nF, inp.nC, nThreads, evals);
+    cout << "[** " << files.size() << " scenarios evaluated with " << nThreads
+         << " threads]" << endl;
+
+    string name = (_OUTNAME != NULL) ? _OUTNAME : "evaluation.txt";
+    ofstream fWriter(name, ios::out);
+    fWriter << setprecision(15);
+    int nFailed = 0, nInfeasible = 0;
+    for (size_t n = 0; n < files.size(); n++)
+    {
+        EVALUATION & ev = evals[n];
+        if (!ev.ok)
+        {
+            cout << "[** Scenario " << files[n] << " cannot be read or does not match the "
+                 << "solution (" << inp.nF << " x " << inp.nC << "): skipped]" << endl;
+            nFailed++;
+            continue;
+        }
+        if (ev.infTot < -EPSI)
+            nInfeasible++;
+        fWriter << files[n] << ";" << _SOLNAME << ";" << ev.fixed << ";" << ev.alloc << ";"
+                << ev.infTot << ";" << ev.infMax << "\n";
+    }
+
+    const char * names[6] = {"mean", "stddev", "min", "median", "q95", "max"};
+    vector<double> fixed  = column_statistics(evals, &EVALUATION::fixed);
+    vector<double> alloc  = column_statistics(evals, &EVALUATION::alloc);
+    vector<double> infTot = column_statistics(evals, &EVALUATION::infTot);
+    vector<double> infMax = column_statistics(evals, &EVALUATION::infMax);
+    for (int k = 0; k < 6; k++)
+        fWriter << names[k] << ";" << _SOLNAME << ";" << fixed[k] << ";" << alloc[k] << ";"
+                << infTot[k] << ";" << infMax[k] << "\n";
+    fWriter.close();
+
+    vector<EVALUATION> total = evals;
+    for (EVALUATION & ev : total)
+        ev.alloc += ev.fixed;
+    vector<double> cost = column_statistics(total, &EVALUATION::alloc);
+    cout << "[** " << files.size() - nFailed << " scenarios evaluated (" << nFailed
+         << " skipped); " << nInfeasible << " with capacity shortage]" << endl;
+    cout << "[** Cost :: mean = " << setprecision(15) << cost[0] << "; stddev = " << cost[1]
+         << "; min = " << cost[2] << "; q95 = " << cost[4] << "; max = " << cost[5] << "]" << endl;
+    cout << "[** Table written to " << name << "]" << endl;
+    return nFailed == (int) files.size() ? 1 : 0;
+}
+
+/// Cross evaluation of the solutions given with -S against the scenarios of -l
+/**
+ * Each scenario is read once, keeping the costs of the union of the
+ * allocations of all the solutions (see allocation_positions()), and all
+ * the solutions are evaluated on it (see evaluate_scenarios()).
+ */
+int evaluate_cross(const char * _LISTNAME, const char * _SOLLIST, char * _OUTNAME, int nThreads)
+{
+    vector<string> files = scenario_files(_LISTNAME);
+    vector<string> solNames = scenario_files(_SOLLIST);
+    if (files.empty() || solNames.empty())
+    {
+        cout << "No " << (files.empty() ? "scenario" : "solution") << " files in "
+             << (files.empty() ? _LISTNAME : _SOLLIST) << endl;
+        return 1;
+    }
+    int nS = files.size(), nK = solNames.size();
+
+    // the solutions are read once, and must refer to the same instance size
+    INSTANCE inp = INSTANCE();
+    vector<SOLUTION> sols;
+    vector<string> solRead;
+    int nF = 0, nC = 0;
+    for (int k = 0; k < nK; k++)
+    {
+        SOLUTION sol;
+        if (readSolution((char *) solNames[k].c_str(), sol, inp) == 0)
+        {
+            cout << "[** Solution " << solNames[k] << " cannot be read: skipped]" << endl;
+            continue;
+        }
+        if (sols.empty())
+        {
+            nF = inp.nF;
+            nC = inp.nC;
+        }
+        else if (inp.nF != nF || inp.nC != nC)
+        {
+            cout << "Solution " << solNames[k] << " has size " << inp.nF << " x " << inp.nC
+                 << ", while " << solRead[0] << " has size " << nF << " x " << nC << endl;
+            return 1;
+        }
+        sols.push_back(sol);
+        solRead.push_back(solNames[k]);
+    }
+    if (sols.empty())
+        return 1;
+    solNames = solRead;
+    nK       = sols.size();
+    vector<long> pos;
+    vector<vector<int>> at;
+    allocation_positions(sols, nF, nC, pos, at);
+
+    vector<EVALUATION> evals; // evals[k*nS + n]: solution k on scenario n
+    nThreads = evaluate_scenarios(files, sols, pos, at, nF, nC, nThreads, evals);
+    cout << "[** Cross evaluation of " << nK << " solutions on " << nS << " scenarios with "
+         << nThreads << " threads (" << pos.size() << " distinct allocations)]" << endl;
+
+    vector<int> good; // scenarios read (a scenario is read or not for all the solutions)
+    for (int n = 0; n < nS; n++)
+        if (evals[n].ok)
+            good.push_back(n);
+        else
+            cout << "[** Scenario " << files[n] << " cannot be read or does not match the "
+                 << "solutions (" << nF << " x " << nC << "): skipped]" << endl;
+    if (good.empty())
+        return 1;
+
+    // cost and infeasibility matrices: one row per solution, one column per scenario
+    string name = (_OUTNAME != NULL) ? _OUTNAME : "evaluation.txt";
+    for (int m = 0; m < 2; m++)
+    {
+        ofstream fWriter(name + (m == 0 ? ".cost" : ".infeas"), ios::out);
+        fWriter << setprecision(15) << "solution";
+        for (int n : good)
+            fWriter << ";" << files[n];
+        fWriter << "\n";
+        for (int k = 0; k < nK; k++)
+        {
+            fWriter << solNames[k];
+            for (int n : good)
+            {
+                EVALUATION & ev = evals[(size_t) k*nS + n];
+                fWriter << ";" << (m == 0 ? ev.fixed + ev.alloc : ev.infTot);
+            }
+            fWriter << "\n";
+        }
+    }
+
+    // summary of each solution over the scenarios
+    ofstream fWriter(name, ios::out);
+    fWriter << setprecision(15) << "solution;mean cost;stddev cost;q95 cost;worst cost;"
+            << "mean shortage;worst shortage;violation probability\n";
+    cout << endl << "** CROSS EVALUATION (" << good.size() << " scenarios) **" << endl;
+    cout << setw(30) << "solution" << setw(18) << "mean cost" << setw(18) << "worst cost"
+         << setw(14) << "P(violation)" << endl;
+    for (int k = 0; k < nK; k++)
+    {
+        vector<double> cost;
+        double shortage = 0.0, worstShortage = 0.0;
+        int nViolated = 0;
+        for (int n : good)
+        {
+            EVALUATION & ev = evals[(size_t) k*nS + n];
+            cost.push_back(ev.fixed + ev.alloc);
+            shortage     += -ev.infTot;
+            worstShortage = max(worstShortage, -ev.infTot);
+            if (ev.infTot < -EPSI)
+                nViolated++;
+        }
+        vector<EVALUATION> total(cost.size());
+        for (unsigned n = 0; n < cost.size(); n++)
+            total[n] = {true, 0.0, cost[n], 0.0, 0.0};
+        vector<double> stat = column_statistics(total, &EVALUATION::alloc);
+        double probability = (double) nViolated/good.size();
+        fWriter << solNames[k] << ";" << stat[0] << ";" << stat[1] << ";" << stat[4] << ";"
+                << stat[5] << ";" << shortage/good.size() << ";" << worstShortage << ";"
+                << probability << "\n";
+        cout << setw(30) << solNames[k] << setw(18) << setprecision(10) << stat[0]
+             << setw(18) << stat[5] << setw(14) << setprecision(4) << probability << endl;
+    }
+    fWriter.close();
+    cout << "[** Summary written to " << name << "; matrices to " << name << ".cost and "
+         << name << ".infeas]" << endl;
+    return 0;
+}
+
+/// Throughput of the evaluation kernels on a random instance with nF = nC = n (flag -b)
+/**
+ * A random multi-source solution (one facility in five open, each customer
+ * split between two of them) is evaluated on BENCH_SCENARIOS random
+ * scenarios held in memory, one scenario at a time with evaluate() and by
+ * blocks with evaluate_block(), in one thread. Reading the scenarios and
+ * packing the blocks are not timed. The values of the two kernels must be
+ * the same.
+ */
+int evaluate_benchmark(int n)
+{
+    const int BENCH_SCENARIOS = 16*SCENARIO_BLOCK;
+    int nF = n, nC = n;
+    mt19937_64 rng(27);
+    uniform_real_distribution<double> unif(0.5, 1.5);
+
+    SOLUTION opt;
+    opt.ySol = new int[nF]();
+    for (int i = 0; i < nF; i += 5)
+        opt.ySol[i] = 1;
+    int nOpen = (nF + 4)/5;
+    opt.xBeg.assign(nC + 1, 0);
+    for (int j = 0; j < nC; j++)
+    {
+        int a = 5*(rng() % nOpen), b = 5*((a/5 + 1 + rng() % max(1, nOpen - 1)) % nOpen);
+        opt.xFac.push_back(min(a, b));
+        opt.xVal.push_back(0.5);
+        if (a != b)
+        {
+            opt.xFac.push_back(max(a, b));
+            opt.xVal.push_back(0.5);
+        }
+        else
+            opt.xVal.back() = 1.0;
+        opt.xBeg[j + 1] = opt.xFac.size();
+    }
+    vector<SOLUTION> sols(1, opt);
+    vector<long> pos;
+    vector<vector<int>> at;
+    allocation_positions(sols, nF, nC, pos, at);
+
+    vector<SCENARIO> sc(BENCH_SCENARIOS);
+    for (SCENARIO & scen : sc)
+    {
+        scen.ok = true;
+        for (int i = 0; i < nF; i++)
+        {
+            scen.s.push_back(10.0*nC/nOpen*unif(rng));
+            scen.f.push_back(100.0*unif(rng));
+        }
+        for (int j = 0; j < nC; j++)
+            scen.d.push_back(10.0*unif(rng));
+        for (unsigned t = 0; t < pos.size(); t++)
+            scen.cost.push_back(unif(rng));
+    }
+    vector<BLOCK> blocks(BENCH_SCENARIOS/SCENARIO_BLOCK);
+    for (unsigned b = 0; b < blocks.size(); b++)
+    {
+        vector<SCENARIO> part(sc.begin() + b*SCENARIO_BLOCK, sc.begin() + (b + 1)*SCENARIO_BLOCK);
+        pack_block(part, SCENARIO_BLOCK, nF, nC, pos.size(), blocks[b]);
+    }
+
+    vector<EVALUATION> scalar(BENCH_SCENARIOS), block(BENCH_SCENARIOS);
+    vector<double> work;
+    double rate[2];
+    for (int m = 0; m < 2; m++) // 0-evaluate(); 1-evaluate_block()
+    {
+        long nEval = 0;
+        auto start = chrono::steady_clock::now();
+        double elapsed = 0.0;
+        while (elapsed < 1.0)
+        {
+            if (m == 0)
+                for (int s = 0; s < BENCH_SCENARIOS; s++)
+                    evaluate(opt, nF, nC, sc[s], at[0], work, scalar[s]);
+            else
+                for (unsigned b = 0; b < blocks.size(); b++)
+                    evaluate_block(opt, nF, nC, at[0], blocks[b], work, &block[b*SCENARIO_BLOCK]);
+            nEval  += BENCH_SCENARIOS;
+            elapsed = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        }
+        rate[m] = nEval/elapsed;
+    }
+
+    int nDiff = 0;
+    for (int s = 0; s < BENCH_SCENARIOS; s++)
+        if (scalar[s].fixed != block[s].fixed || scalar[s].alloc != block[s].alloc
+            || scalar[s].infTot != block[s].infTot || scalar[s].infMax != block[s].infMax)
+            nDiff++;
+    cout << "[** Evaluation kernels :: nF = " << nF << "; nC = " << nC << "; "
+         << opt.xFac.size() << " allocations; " << BENCH_SCENARIOS << " scenarios]" << endl;
+    cout << setw(28) << "one scenario at a time" << setw(14) << setprecision(6) << rate[0]
+         << " evaluations/s" << endl;
+    cout << setw(28) << "blocks of scenarios" << setw(14) << rate[1] << " evaluations/s ("
+         << setprecision(3) << rate[1]/rate[0] << "x)" << endl;
+    cout << "[** " << nDiff << " evaluations differ between the kernels]" << endl;
+    delete [] opt.ySol;
+    return nDiff > 0 ? 1 : 0;
+}
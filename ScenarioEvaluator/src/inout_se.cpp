@@ -22,6 +22,7 @@
  * * Read nominal instance from disk (both OR Library and Avella). See the
  *   introduction part of rcflp.cpp to see how the costs \f$c_{ij}\f$ are
  *   managed in the two instance types.
+ * * Map nominal instances stored in binary format. See readBinaryProblemData()
  * * Read parameters for the different support sets. Currently, we read
  *   parameters for the following sets:
  *   * Ellipsoidal support set. See read_parameters_ellipsoidal()
@@ -38,6 +39,12 @@ ILOSTLBEGIN
 #include <iomanip>
 #include <cstdlib>
 #include <fstream>
+#include <cstring>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
 
 
@@ -51,6 +58,7 @@ struct INSTANCE { /// See same data structure define in rcflp.cpp
     double  *s;
     double  *d;
     double **c;
+    double  *cT;   // costs in customer-major format (cT[j*nF+i])
     double   totS;
     double   totD;
 
@@ -64,7 +72,9 @@ struct INSTANCE { /// See same data structure define in rcflp.cpp
 struct SOLUTION {
     int nOpen;
     int  *ySol;
-    double **xSol;
+    vector<int>    xBeg;  // customer-major sparse allocations (see ScenarioEvaluator.cpp)
+    vector<int>    xFac;
+    vector<double> xVal;
     double zStar; 
     IloAlgorithm::Status zStatus;
     IloNum startTime;
@@ -74,16 +84,145 @@ struct SOLUTION {
 extern string instanceType;
 
 
+/// Header of the binary instance format (see readBinaryProblemData())
+struct BINHEADER {
+    char   magic[8];   //!< "RCFLPBIN"
+    int    version;    //!< format version (currently 1)
+    int    fType;      //!< type of the text instance it was converted from (1-2)
+    int    nF;         //!< number of facilities
+    int    nC;         //!< number of customers
+    double totS;       //!< total supply
+    double totD;       //!< total demand
+    char   pad[24];    //!< padding to 64 bytes
+};
+const char BINMAGIC[8] = {'R','C','F','L','P','B','I','N'};
+const int  BINVERSION  = 1;
+const long BINALIGN    = 64; //!< every array starts on a 64-byte boundary
+
+/// Offsets (in bytes) of the arrays f, s, d and c in a binary instance file.
+/** The last element of `off` is the total size of the file. */
+void binary_offsets(int nF, int nC, long off[5])
+{
+    long n[4] = {(long)nF, (long)nF, (long)nC, (long)nF*(long)nC};
+    off[0] = sizeof(BINHEADER);
+    for (int k = 0; k < 4; k++)
+    {
+        off[k] = (off[k] + BINALIGN - 1)/BINALIGN*BINALIGN;
+        off[k+1] = off[k] + n[k]*(long)sizeof(double);
+    }
+}
+
+/// Check whether a file is an instance in binary format (by its magic number).
+bool isBinaryInstance(char * _FILENAME)
+{
+    char magic[8];
+    ifstream fReader(_FILENAME, ios::in | ios::binary);
+    if (!fReader || !fReader.read(magic, 8))
+        return false;
+    return memcmp(magic, BINMAGIC, 8) == 0;
+}
+
+/// Read an instance stored in binary format.
+/**
+ * The file is produced by the InstanceConverter tool and contains a
+ * BINHEADER followed by the arrays f[nF], s[nF], d[nC] and c[nF*nC]. The
+ * costs are stored row by row (facility-major) and are already the unit
+ * costs used internally, i.e., OR Library costs are divided by \f$d_j\f$.
+ *
+ * The file is mapped in memory (`mmap`) instead of being read, and the
+ * instance arrays point directly into the mapping. The mapping is private
+ * and read-only in practice: all the processes loading the same file share
+ * the pages of the page cache, and no copy of the cost matrix is made.
+ */
+int readBinaryProblemData(char * _FILENAME, INSTANCE & inp)
+{
+    int fd = open(_FILENAME, O_RDONLY);
+    if (fd < 0)
+    {
+        cout << "cannot open file " << _FILENAME << endl;
+        exit(1);
+    }
+    struct stat st;
+    fstat(fd, &st);
+    if ((size_t)st.st_size < sizeof(BINHEADER))
+    {
+        cout << "Binary instance " << _FILENAME << " is truncated." << endl;
+        exit(1);
+    }
+    // private mapping: pages are shared until (if ever) somebody writes them
+    char * base = (char *) mmap(NULL, st.st_size, PROT_READ | PROT_WRITE,
+                                MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED)
+    {
+        cout << "cannot map file " << _FILENAME << endl;
+        exit(1);
+    }
+
+    BINHEADER * head = (BINHEADER *) base;
+    long off[5];
+    binary_offsets(head->nF, head->nC, off);
+    if (memcmp(head->magic, BINMAGIC, 8) != 0 || head->version != BINVERSION
+        || head->nF <= 0 || head->nC <= 0 || off[4] > (long)st.st_size)
+    {
+        cout << "Binary instance " << _FILENAME << " is corrupted." << endl;
+        exit(1);
+    }
+
+    inp.nF   = head->nF;
+    inp.nC   = head->nC;
+    inp.totS = head->totS;
+    inp.totD = head->totD;
+    inp.f    = (double *) (base + off[0]);
+    inp.s    = (double *) (base + off[1]);
+    inp.d    = (double *) (base + off[2]);
+    inp.c    = new double*[inp.nF];
+    for (int i = 0; i < inp.nF; i++)
+        inp.c[i] = (double *) (base + off[3]) + (long)i*inp.nC;
+
+    return head->fType;
+}
+
+/// Allocate the cost matrix as a single aligned block.
+/**
+ * The costs are stored row by row (facility-major) in one contiguous buffer
+ * aligned to BINALIGN bytes, and `c[i]` points to the beginning of row `i`.
+ * Loops over \f$c_{ij}\f$ thus run over consecutive memory, and the layout
+ * is the same as the one used in the binary format.
+ */
+void allocate_costs(INSTANCE & inp)
+{
+    size_t bytes = ((size_t)inp.nF*inp.nC*sizeof(double) + BINALIGN - 1)/BINALIGN*BINALIGN;
+    double * buffer = (double *) aligned_alloc(BINALIGN, bytes);
+    inp.c = new double*[inp.nF];
+    for (int i = 0; i < inp.nF; i++)
+        inp.c[i] = buffer + (long)i*inp.nC;
+}
+
 /// Read benchmark instances
 /**
  * Currently, two types of instances can be imported:
  * type 1: OR Library
  * type 2: Avella (Test Bed 1, Test Bed A. Test Bed B)
+ *
+ * Instances converted to the binary format (see readBinaryProblemData()) are
+ * recognized automatically and are mapped in memory instead of being parsed.
  */
 int readProblemData(char * _FILENAME, int fType, INSTANCE & inp)
 {
     inp.totS = 0.0;
+    inp.cT   = NULL;
     inp.totD = 0.0;
+    // binary instances are recognized by their header, whatever the -t flag
+    if (isBinaryInstance(_FILENAME))
+    {
+        int binType = readBinaryProblemData(_FILENAME, inp);
+        if (binType != fType)
+            cout << "[** Binary instance converted from type " << binType
+                 << ", but -t " << fType << " was given]" << endl;
+        return 1;
+    }
+
     ifstream fReader(_FILENAME, ios::in);
     if (!fReader)
     {
@@ -98,9 +237,7 @@ int readProblemData(char * _FILENAME, int fType, INSTANCE & inp)
         inp.s = new double[inp.nF];
         inp.f = new double[inp.nF];
         inp.d = new double[inp.nC];
-        inp.c = new double*[inp.nF];
-        for (int i = 0; i < inp.nF; i++)
-            inp.c[i] = new double[inp.nC];
+        allocate_costs(inp);
 
         for (int i = 0; i < inp.nF; i++)
         {
@@ -129,9 +266,7 @@ int readProblemData(char * _FILENAME, int fType, INSTANCE & inp)
         inp.f = new double[inp.nF];
         inp.s = new double[inp.nF];
         inp.d = new double[inp.nC];
-        inp.c = new double*[inp.nF];
-        for (int i = 0; i < inp.nF; i++)
-            inp.c[i] = new double[inp.nC];
+        allocate_costs(inp);
         for (int j = 0; j < inp.nC; j++)
         {
             fReader >> inp.d[j];
@@ -158,9 +293,14 @@ int readProblemData(char * _FILENAME, int fType, INSTANCE & inp)
 }
 
 
+/// Read a solution; returns 0 if the file cannot be opened or an index is out of range
 int readSolution(char * _SOLNAME, SOLUTION & opt, INSTANCE & inp)
 {
 	ifstream fReader(_SOLNAME, ios::in);
+	if (!fReader){
+		cout << "Cannot open file '" << _SOLNAME << "'." << endl;
+		return 0;
+	}
 	string firstline;
 	fReader >> firstline;
 
@@ -170,33 +310,56 @@ int readSolution(char * _SOLNAME, SOLUTION & opt, INSTANCE & inp)
 	string zStatus_temp;
 	fReader >> zStatus_temp;
 	fReader >> opt.nOpen;
+	if (!fReader || inp.nF <= 0 || inp.nC <= 0 || opt.nOpen < 0 || opt.nOpen > inp.nF){
+		cout << "Solution file '" << _SOLNAME << "': bad header." << endl;
+		return 0;
+	}
 
 	opt.ySol = new int[inp.nF];
 	for (int i = 0; i < inp.nF; i++) opt.ySol[i]=0;
 	for (int i = 0; i < opt.nOpen; i++){
 		int facility_ind;
 		fReader >> facility_ind;
+		if (!fReader || facility_ind < 0 || facility_ind >= inp.nF){
+			cout << "Solution file '" << _SOLNAME << "': bad open facility." << endl;
+			delete [] opt.ySol;
+			return 0;
+		}
 		opt.ySol[facility_ind]=1;	
 	}
 
-	opt.xSol= new double*[inp.nF];
-	for (int i = 0; i < inp.nF; i++) opt.xSol[i]= new double[inp.nC];
-
-
-	while(!fReader.eof()){
-		int a,b;
-		double val;
-		fReader >> a;
-		cout << a<< endl;
-		fReader >> b;
-		fReader >> val;
-		opt.xSol[a][b]= val;
-
+	// nonzero allocations (facility, customer, value), stored by customer
+	vector<int> fac, cus;
+	vector<double> vals;
+	int a,b;
+	double val;
+	while (fReader >> a >> b >> val){
+		if (a < 0 || a >= inp.nF || b < 0 || b >= inp.nC){
+			cout << "Solution file '" << _SOLNAME << "': allocation " << a << " " << b
+			     << " out of range." << endl;
+			delete [] opt.ySol;
+			return 0;
+		}
+		fac.push_back(a);
+		cus.push_back(b);
+		vals.push_back(val);
 	}
 	fReader.close();
+
+	opt.xBeg.assign(inp.nC + 1, 0);
+	for (unsigned k = 0; k < cus.size(); k++) opt.xBeg[cus[k] + 1]++;
+	for (int j = 0; j < inp.nC; j++) opt.xBeg[j + 1] += opt.xBeg[j];
+	vector<int> pos(opt.xBeg.begin(), opt.xBeg.end() - 1);
+	opt.xFac.resize(cus.size());
+	opt.xVal.resize(cus.size());
+	for (unsigned k = 0; k < cus.size(); k++){
+		opt.xFac[pos[cus[k]]]= fac[k];
+		opt.xVal[pos[cus[k]]++]= vals[k];
+	}
+	return 1;
 }
 
-void printOptions(char * _FILENAME,char * _SOLNAME, INSTANCE inp, int timeLimit)
+void printOptions(char * _FILENAME,char * _SOLNAME, INSTANCE & inp, int timeLimit)
 {
    cout << "-------------------------------------" << endl;
    cout << "- OPTIONS : " << endl;
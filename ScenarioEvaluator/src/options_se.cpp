@@ -14,12 +14,30 @@ extern char* _SOLNAME;
 extern string instanceType;
 extern char* _OUTNAME;
 extern int fType;           //!< instance type (1-2)
+extern char* _LISTNAME;     //!< scenario files to evaluate (directory, pattern or list)
+extern int nThreads;        //!< threads of the evaluation of a list (0: all cores)
+extern char* _SOLLIST;      //!< solution files of a cross evaluation (directory, pattern or list)
+extern int benchSize;       //!< size of the benchmark of the evaluation kernels (0: none)
+extern int recourseMode;    //!< 0-planned allocations; 1-reallocation (MS); 2-reallocation (SS)
+extern int support;         //!< worst case over the support (0-no; 1-box; 2-budget; 3-ellipsoidal)
+extern double _epsilon;     //!< relative deviation of the demand in the support
+extern double _Omega;       //!< radius of the ellipsoidal support
+extern char* _BUDGETNAME;   //!< sets B_l and budgets b_l of the budget support (rcflp .budget file)
 
 
 int parseOptions(int argc, char* argv[]) 
 {
    bool setFile = false;
    bool setType = false;
+   _LISTNAME = NULL;
+   nThreads = 0;
+   _SOLLIST = NULL;
+   benchSize = 0;
+   recourseMode = 0;
+   support = 0;
+   _epsilon = -1;
+   _Omega = -1;
+   _BUDGETNAME = NULL;
 
    cout <<endl << "R-CLSP v1.0 " << endl;
    if (argc == 1)
@@ -57,6 +75,45 @@ int parseOptions(int argc, char* argv[])
 	       setFile = true;
 	       i++;
 	       break;
+	    case 'l':
+	       _LISTNAME = argv[i+1];
+	       setFile = true;
+	       i++;
+	       break;
+	    case 'S':
+	       _SOLLIST = argv[i+1];
+	       setFile = true;
+	       i++;
+	       break;
+	    case 'b':
+	       benchSize = atol(argv[i+1]);
+	       setFile = setType = true;
+	       i++;
+	       break;
+	    case 'r':
+	       recourseMode = atol(argv[i+1]);
+	       i++;
+	       break;
+	    case 'u':
+	       support = atol(argv[i+1]);
+	       i++;
+	       break;
+	    case 'e':
+	       _epsilon = atof(argv[i+1]);
+	       i++;
+	       break;
+	    case 'O':
+	       _Omega = atof(argv[i+1]);
+	       i++;
+	       break;
+	    case 'B':
+	       _BUDGETNAME = argv[i+1];
+	       i++;
+	       break;
+	    case 'n':
+	       nThreads = atol(argv[i+1]);
+	       i++;
+	       break;
 	    case 't':
 	       fType = atol(argv[i+1]);
                setType = true;
@@ -68,6 +125,15 @@ int parseOptions(int argc, char* argv[])
 	       cout << "-o : output name" << endl;
 	       cout << "-s : solution file" << endl;
 	       cout << "-t : instance type (1-OR Library; 2-Avella)" << endl;
+	       cout << "-l : scenario files: directory, quoted pattern or list file (one run, all scenarios)" << endl;
+	       cout << "-S : solution files: directory, quoted pattern or list file (cross evaluation with -l)" << endl;
+	       cout << "-b : benchmark of the evaluation kernels with nF = nC = n (e.g., -b 1000)" << endl;
+	       cout << "-r : demand reallocated to the open facilities (0-No; 1-Multi-source; 2-Single-source)" << endl;
+	       cout << "-u : worst case of the solution over the support (0-No; 1-Box; 2-Budget; 3-Ellipsoidal)" << endl;
+	       cout << "-e : epsilon of the support (demand in [(1-e)d, (1+e)d])" << endl;
+	       cout << "-O : Omega of the ellipsoidal support" << endl;
+	       cout << "-B : sets and budgets of the budget support (.budget file written by rcflp)" << endl;
+	       cout << "-n : threads of the evaluation of a list (default 0: all cores)" << endl;
 	       cout << endl;
 	       return -1;
 	 }
@@ -0,0 +1,447 @@
+/***************************************************************************
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+/*! \file oracle_se.cpp
+  \brief Worst case of a solution over a support (flag -u).
+
+ * With **-u** `support`, the solution given with -s is checked against the
+ * support of rcflp, on the nominal instance given with -i: for each open
+ * facility we compute its worst-case load
+ * \f$\max_{\tilde{d} \in U} \sum_j x_{ij} \tilde{d}_j\f$, and we compute the
+ * worst-case transportation cost
+ * \f$\max_{\tilde{d} \in U} \sum_j (\sum_i c_{ij} x_{ij}) \tilde{d}_j\f$, i.e.,
+ * the left hand sides of the robust capacity constraints and the robust
+ * objective of rcflp. The solution is robust feasible if no worst-case
+ * load exceeds the capacity. No model is solved, except in the last case
+ * below:
+ * - **-u 1** : box \f$(1-\epsilon) d_j \leq \tilde{d}_j \leq (1+\epsilon) d_j\f$
+ *   (**-e** \f$\epsilon\f$): every demand at its upper bound;
+ * - **-u 2** : budget, i.e., the box plus
+ *   \f$\sum_{j \in B_l} \tilde{d}_j \leq b_l\f$, with the sets and budgets
+ *   of the file given with **-B** (the `support/<instance>.budget` file
+ *   written by rcflp). We start from the lower bounds, and the demands with
+ *   the largest weights are raised first, as far as the bounds and the
+ *   budgets allow. This greedy is exact when the sets are laminar (e.g., a
+ *   single set, or disjoint ones), since the support is then a polymatroid
+ *   shifted by the lower bounds. For other families of sets the greedy only
+ *   gives a lower bound. If it matches the upper bound obtained by raising
+ *   each demand as far as its own bounds and budgets allow, it is still
+ *   exact; otherwise the linear program is solved with cplex;
+ * - **-u 3** : ellipsoidal (**-e** \f$\epsilon\f$, **-O** \f$\Omega\f$):
+ *   closed form of define_SOCP_CFLP() in rcflp, i.e., the load is
+ *   \f$\sum_j d_j x_{ij} + \Omega \epsilon \|x_{i\cdot}\|\f$ and the cost is
+ *   \f$\sum_{ij} c_{ij} d_j x_{ij} + \Omega \epsilon \|c \circ x\|\f$.
+ *
+ * Only the customers served by a facility have a weight in its load, so
+ * the work of a facility is proportional to its number of customers. The
+ * open facilities (and the cost) are split among **-n** threads. Each
+ * thread builds at most one linear program, in its own cplex environment
+ * and with one cplex thread, over all the demands: from one facility to
+ * the next only the objective changes. If a linear program fails, the
+ * upper bound above is used, so the worst case is overestimated.
+ */
+
+#include <ilcplex/ilocplex.h>
+ILOSTLBEGIN
+
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <cstdlib>
+#include <cmath>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <thread>
+#include <atomic>
+#include <chrono>
+
+using namespace std;
+
+
+struct INSTANCE { /// See same data structure define in ScenarioEvaluator.cpp
+    int nF;
+    int nC;
+    double  *f;
+    double  *s;
+    double  *d;
+    double **c;
+    double  *cT;   // costs in customer-major format (cT[j*nF+i])
+    double   totS;
+    double   totD;
+
+    int nR;        // number of constraints polyhedron uncertainty set
+    double  *h;    // rhs of polyhedron definining support
+    int     *W;    // matrix W in column major format
+    int *index;    // index of column major format for w
+    int *start;    // starting position for elements of column j
+};
+
+struct SOLUTION { /// See same data structure define in ScenarioEvaluator.cpp
+    int nOpen;
+    int  *ySol;
+    vector<int>    xBeg;  // customer-major sparse allocations (see ScenarioEvaluator.cpp)
+    vector<int>    xFac;
+    vector<double> xVal;
+    double zStar;
+    IloAlgorithm::Status zStatus;
+    IloNum startTime;
+    IloNum cpuTime;
+};
+
+extern char * _FILENAME;
+extern char * _SOLNAME;
+extern IloEnv env;
+const double EPSI = 0.00001;
+
+/// Support of the demand (see the description of the file)
+struct SUPPORT {
+    int    type;                 //!< 1-Box; 2-Budget; 3-Ellipsoidal
+    double epsilon;
+    double Omega;
+    vector<double> lo;           //!< Lower bounds of the demands
+    vector<double> hi;           //!< Upper bounds of the demands
+    vector<vector<int>> sets;    //!< Sets B_l
+    vector<double> slack;        //!< b_l minus the lower bounds of B_l
+    vector<vector<int>> setsOf;  //!< Sets including each customer
+    bool   laminar;              //!< Sets pairwise disjoint or nested (greedy is exact)
+};
+
+/// Sparse weights of the demands, e.g., the allocations of a facility
+typedef vector<pair<int, double>> WEIGHTS;
+
+
+/// Read the sets B_l and the budgets b_l (file written by rcflp, see save_instance_2_disk())
+bool read_budget_sets(const char * _BUDGETNAME, int nC, SUPPORT & U)
+{
+    ifstream fReader(_BUDGETNAME, ios::in);
+    if (!fReader)
+    {
+        cout << "Cannot open file '" << _BUDGETNAME << "'." << endl;
+        return false;
+    }
+    int nBl;
+    while (fReader >> nBl)
+    {
+        vector<int> set(nBl);
+        for (int k = 0; k < nBl; k++)
+            fReader >> set[k];
+        double budget;
+        fReader >> budget;
+        for (int j : set)
+            if (j < 0 || j >= nC)
+            {
+                cout << "Budget set with customer " << j << " out of range." << endl;
+                return false;
+            }
+        U.sets.push_back(set);
+        U.slack.push_back(budget);
+    }
+    return true;
+}
+
+/// Define the support of type U.type on the nominal demand d
+bool define_support(INSTANCE & inp, const char * _BUDGETNAME, SUPPORT & U)
+{
+    U.lo.resize(inp.nC);
+    U.hi.resize(inp.nC);
+    for (int j = 0; j < inp.nC; j++)
+    {
+        U.lo[j] = inp.d[j]*(1.0 - U.epsilon);
+        U.hi[j] = inp.d[j]*(1.0 + U.epsilon);
+    }
+    U.laminar = true;
+    if (U.type != 2)
+        return true;
+    if (_BUDGETNAME == NULL)
+    {
+        cout << "Option -B is mandatory with -u 2. Try -h" << endl;
+        return false;
+    }
+    if (!read_budget_sets(_BUDGETNAME, inp.nC, U))
+        return false;
+
+    int L = U.sets.size();
+    U.setsOf.assign(inp.nC, vector<int>());
+    for (int l = 0; l < L; l++)
+        for (int j : U.sets[l])
+        {
+            U.setsOf[j].push_back(l);
+            U.slack[l] -= U.lo[j];
+        }
+    for (int l = 0; l < L; l++)
+    {
+        if (U.slack[l] < -EPSI)
+        {
+            cout << "Budget " << l << " is smaller than the sum of the lower bounds: "
+                 << "empty support." << endl;
+            return false;
+        }
+        U.slack[l] = max(0.0, U.slack[l]); // rounding of the budget
+    }
+
+    // laminar: any two sets are disjoint or nested
+    vector<int> size(L);
+    for (int l = 0; l < L; l++)
+        size[l] = U.sets[l].size();
+    vector<vector<int>> common(L, vector<int>(L, 0));
+    for (int j = 0; j < inp.nC; j++)
+        for (int a : U.setsOf[j])
+            for (int b : U.setsOf[j])
+                common[a][b]++;
+    for (int a = 0; a < L; a++)
+        for (int b = a + 1; b < L; b++)
+            if (common[a][b] > 0 && common[a][b] < min(size[a], size[b]))
+                U.laminar = false;
+    return true;
+}
+
+/// Linear program of the worst case on a non-laminar budget support (one per thread)
+/**
+ * The variables are the raises \f$z_j\f$ of all the demands above their
+ * lower bounds, and the rows are the budgets: only the objective depends
+ * on the weights. Demands without weight may be raised by the solver, but
+ * this does not change the optimal value.
+ */
+struct WORST_LP {
+    IloEnv         env;
+    IloModel       model;
+    IloNumVarArray z;
+    IloObjective   obj;
+    IloCplex       cplex;
+    bool           built = false;
+};
+
+/// Build the linear program of the worst case (see WORST_LP)
+void worst_lp_define(SUPPORT & U, WORST_LP & lp)
+{
+    int nC = U.lo.size();
+    lp.model = IloModel(lp.env);
+    lp.z     = IloNumVarArray(lp.env, nC);
+    for (int j = 0; j < nC; j++)
+        lp.z[j] = IloNumVar(lp.env, 0.0, U.hi[j] - U.lo[j], ILOFLOAT);
+    for (unsigned l = 0; l < U.sets.size(); l++)
+    {
+        IloExpr row(lp.env);
+        for (int j : U.sets[l])
+            row += lp.z[j];
+        lp.model.add(row <= U.slack[l]);
+        row.end();
+    }
+    lp.obj = IloMaximize(lp.env);
+    lp.model.add(lp.obj);
+    lp.cplex = IloCplex(lp.model);
+    lp.cplex.setOut(lp.env.getNullStream());
+    lp.cplex.setWarning(lp.env.getNullStream());
+    lp.cplex.setParam(IloCplex::Param::Threads, 1);
+    lp.built = true;
+}
+
+/// \f$\max_{\tilde{d} \in U} \sum_j w_j \tilde{d}_j\f$ for w >= 0 (box or budget support)
+/**
+ * The demands without weight stay at their lower bounds, which leaves the
+ * most room in the budgets. See the description of the file for the greedy
+ * and its upper bound. The linear program (non-laminar sets only) is built
+ * in `lp` at its first use; `failed` is set if it is not solved.
+ */
+double worst_case(SUPPORT & U, WEIGHTS & w, vector<double> & slack, WORST_LP & lp, bool & failed)
+{
+    double value = 0.0;
+    failed = false;
+    if (U.type == 1)
+    {
+        for (auto & jw : w)
+            value += jw.second*U.hi[jw.first];
+        return value;
+    }
+
+    double base = 0.0, bound = 0.0;
+    slack = U.slack;
+    sort(w.begin(), w.end(), [](const pair<int, double> & a, const pair<int, double> & b) {
+        return a.second > b.second;
+    });
+    for (auto & jw : w)
+    {
+        int j = jw.first;
+        double room  = U.hi[j] - U.lo[j];
+        for (int l : U.setsOf[j])
+            room = min(room, U.slack[l]);
+        double raise = U.hi[j] - U.lo[j];
+        for (int l : U.setsOf[j])
+            raise = min(raise, slack[l]);
+        raise = max(0.0, raise);
+        for (int l : U.setsOf[j])
+            slack[l] -= raise;
+        base  += jw.second*U.lo[j];
+        value += jw.second*raise;
+        bound += jw.second*room;
+    }
+    if (U.laminar || value >= bound - EPSI*max(1.0, bound))
+        return base + value;
+
+    try
+    {
+        if (!lp.built)
+            worst_lp_define(U, lp);
+        for (auto & jw : w)
+            lp.obj.setLinearCoef(lp.z[jw.first], jw.second);
+        bool solved = lp.cplex.solve();
+        double lpValue = solved ? lp.cplex.getObjValue() : bound;
+        for (auto & jw : w)
+            lp.obj.setLinearCoef(lp.z[jw.first], 0.0);
+        failed = !solved;
+        return base + max(value, lpValue);
+    }
+    catch (IloException & e)
+    {
+        failed = true;
+        return base + bound;
+    }
+}
+
+/// Worst-case load of every open facility and worst-case cost of the solution (flag -u)
+int evaluate_worst_case(INSTANCE & inp, SOLUTION & opt, int support, double epsilon,
+                        double Omega, const char * _BUDGETNAME, char * _OUTNAME, int nThreads)
+{
+    auto start = chrono::steady_clock::now();
+    SUPPORT U;
+    U.type    = support;
+    U.epsilon = epsilon;
+    U.Omega   = Omega;
+    if (support < 1 || support > 3 || epsilon < 0.0 || (support == 3 && Omega < 0.0))
+    {
+        cout << "Support -u 1, 2 or 3 with -e (and -O for -u 3) is needed. Try -h" << endl;
+        return 1;
+    }
+    if (!define_support(inp, _BUDGETNAME, U))
+        return 1;
+
+    // weights: allocations of each facility, and costs of the customers
+    int nF = inp.nF, nC = inp.nC;
+    vector<WEIGHTS> load(nF);
+    WEIGHTS cost;
+    double nominal = 0.0, fixed = 0.0, costSq = 0.0;
+    for (int i = 0; i < nF; i++)
+        fixed += opt.ySol[i]*inp.f[i];
+    for (int j = 0; j < nC; j++)
+    {
+        double cj = 0.0;
+        for (int k = opt.xBeg[j]; k < opt.xBeg[j+1]; k++)
+        {
+            double cx = opt.xVal[k]*inp.c[opt.xFac[k]][j];
+            load[opt.xFac[k]].push_back(make_pair(j, opt.xVal[k]));
+            cj      += cx;
+            costSq  += cx*cx;
+            nominal += cx*inp.d[j];
+        }
+        if (cj > 0.0)
+            cost.push_back(make_pair(j, cj));
+    }
+
+    // facilities (task i < nF) and cost (task nF), split among the threads
+    vector<double> lin(nF, 0.0), worst(nF, 0.0);
+    double worstCost = 0.0;
+    if (nThreads <= 0)
+        nThreads = max(1u, thread::hardware_concurrency());
+    nThreads = max(1, min(nThreads, nF + 1));
+    atomic<int> next(0), nFailed(0);
+    auto work = [&]() {
+        vector<double> slack;
+        WORST_LP lp;
+        bool failed;
+        for (int t = next++; t <= nF; t = next++)
+        {
+            WEIGHTS & w = (t < nF) ? load[t] : cost;
+            if (t < nF && w.empty())
+                continue;
+            double value;
+            if (U.type == 3) // closed form (see the description of the file)
+            {
+                double mean = 0.0, sq = 0.0;
+                for (auto & jw : w)
+                {
+                    mean += jw.second*inp.d[jw.first];
+                    sq   += jw.second*jw.second;
+                }
+                value = (t < nF) ? mean + U.Omega*U.epsilon*sqrt(sq)
+                                 : mean + U.Omega*U.epsilon*sqrt(costSq);
+            }
+            else
+            {
+                value = worst_case(U, w, slack, lp, failed);
+                nFailed += failed;
+            }
+            if (t < nF)
+            {
+                worst[t] = value;
+                for (auto & jw : w)
+                    lin[t] += jw.second*inp.d[jw.first];
+            }
+            else
+                worstCost = value;
+        }
+        lp.env.end();
+    };
+    vector<thread> workers;
+    for (int t = 1; t < nThreads; t++)
+        workers.push_back(thread(work));
+    work();
+    for (auto & worker : workers)
+        worker.join();
+    double elapsed = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    const char * names[4] = {"", "box", "budget", "ellipsoidal"};
+    cout << endl << "** WORST CASE (" << names[U.type] << " support"
+         << (U.type == 2 ? (U.laminar ? ", greedy" : ", greedy and linear programs") : "") << ") **" << endl;
+    cout << setw(10) << "facility" << setw(16) << "capacity" << setw(16) << "nominal load"
+         << setw(16) << "worst load" << setw(16) << "slack" << endl;
+    int nViolated = 0;
+    double maxOverload = 0.0;
+    for (int i = 0; i < nF; i++)
+    {
+        if (opt.ySol[i] != 1 && load[i].empty())
+            continue;
+        double cap   = opt.ySol[i]*inp.s[i];
+        double slack = cap - worst[i];
+        if (slack < -EPSI*max(1.0, cap))
+        {
+            nViolated++;
+            maxOverload = max(maxOverload, -slack);
+        }
+        cout << setw(10) << i << setw(16) << setprecision(10) << cap << setw(16) << lin[i]
+             << setw(16) << worst[i] << setw(16) << slack << (slack < -EPSI*max(1.0, cap) ? "  *" : "")
+             << endl;
+    }
+    cout << "[** Cost :: nominal = " << setprecision(15) << fixed + nominal << "; worst case = "
+         << fixed + worstCost << "]" << endl;
+    cout << "[** " << (nViolated == 0 ? "Robust feasible" : "NOT robust feasible") << " :: "
+         << nViolated << " facilities overloaded in the worst case; max overload = "
+         << maxOverload << " (" << setprecision(4) << 1000.0*elapsed << " ms)]" << endl;
+    if (nFailed > 0)
+        cout << "[** " << nFailed << " linear programs not solved: upper bound used, "
+             << "the worst case might be overestimated]" << endl;
+
+    if (_OUTNAME != NULL)
+    {
+        ofstream fWriter(_OUTNAME, ios::out);
+        fWriter << setprecision(15) << _FILENAME << ";" << _SOLNAME << ";" << names[U.type]
+                << ";" << fixed + nominal << ";" << fixed + worstCost << ";" << nViolated << ";"
+                << maxOverload << endl;
+        fWriter.close();
+    }
+    return 0;
+}
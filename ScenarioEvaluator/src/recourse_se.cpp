@@ -0,0 +1,303 @@
+/***************************************************************************
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+/*! \file recourse_se.cpp
+  \brief Reallocation of the demand of a scenario to the open facilities (flag -r).
+
+ * With **-r**, the open facilities of the solution are kept, but its
+ * allocations are not: once the demand of a scenario is known, it is
+ * reallocated to the open facilities at minimum cost, and the recourse cost
+ * and the unmet demand are reported instead of the capacity shortage of the
+ * planned allocations (see batch_se.cpp). No cplex model is built.
+ *
+ * - **-r 1** : multi-source. The transportation problem
+ *   \f[ \min \sum_{ij} c_{ij} d_j x_{ij}, \quad \sum_i x_{ij} = 1, \quad
+ *   \sum_j d_j x_{ij} \leq s_i \f]
+ *   over the open facilities is solved exactly by successive shortest paths
+ *   (see recourse_transportation()). The demand that does not fit in the
+ *   open facilities goes to a dummy facility of infinite capacity and
+ *   prohibitive cost, i.e., it is the unmet demand.
+ * - **-r 2** : single-source. Each customer goes to one facility: the
+ *   planned one, if it is open, or the cheapest one. The overloaded
+ *   facilities are then repaired, and customers are moved to cheaper
+ *   facilities while the capacities allow it (see recourse_assignment()).
+ *   This is a heuristic: the cost is an upper bound on the best recourse.
+ */
+
+#include <iostream>
+#include <cstdlib>
+#include <cmath>
+#include <vector>
+#include <queue>
+#include <algorithm>
+#include <functional>
+
+using namespace std;
+
+const double FLOW_EPSI = 1e-9; //!< Flows and capacities below FLOW_EPSI * demand are zero
+
+
+/// Optimal multi-source reallocation (see the description of the file)
+/**
+ * `open` are the open facilities, and `cost[a][j]` is the unit cost of
+ * customer `j` at facility `open[a]`. The demand of the customers is
+ * routed one customer at a time, along shortest paths of the residual
+ * network: from customer \f$j\f$ to facility \f$a\f$ (cost \f$c_{aj}\f$),
+ * then possibly from \f$a\f$ to \f$b\f$ by moving part of the demand of a
+ * customer \f$k\f$ served by \f$a\f$ (cost \f$c_{bk} - c_{ak}\f$), until a
+ * facility with residual capacity is reached. The network is contracted
+ * on the facilities, and the costs are made nonnegative by potentials
+ * (updated after every path), so that the paths are found by Dijkstra's
+ * algorithm. The flow of the routed demand is thus optimal at every step.
+ * When capacities are loose, the search stops at the first facility,
+ * and the cost of a customer is \f$O(m \log m)\f$ for \f$m\f$ open facilities.
+ *
+ * Returns the allocation cost; `unmet` and `unmetMax` are the total unmet
+ * demand and the largest unmet demand of a customer.
+ */
+double recourse_transportation(vector<int> & open, int nC, const double * s, const double * d,
+                               vector<const double *> & cost, double & unmet, double & unmetMax)
+{
+    int m = open.size(), u = m; // u: dummy facility of the unmet demand
+    double cMin = INFINITY, cMax = -INFINITY, dMax = 0.0;
+    for (int a = 0; a < m; a++)
+        for (int j = 0; j < nC; j++)
+        {
+            cMin = min(cMin, cost[a][j]);
+            cMax = max(cMax, cost[a][j]);
+        }
+    for (int j = 0; j < nC; j++)
+        dMax = max(dMax, d[j]);
+    if (m == 0)
+        cMin = cMax = 0.0;
+    // longer than any path through real facilities: only demand that fits nowhere is unmet
+    double penalty = (m + 1)*(cMax - cMin) + fabs(cMax) + 1.0;
+    double epsi    = FLOW_EPSI*max(1.0, dMax);
+    // costs by customer, dummy facility last: the facilities of a customer are contiguous
+    vector<double> cT((size_t) nC*(m + 1));
+    for (int a = 0; a < m; a++)
+        for (int j = 0; j < nC; j++)
+            cT[(size_t) j*(m + 1) + a] = cost[a][j];
+    for (int j = 0; j < nC; j++)
+        cT[(size_t) j*(m + 1) + u] = penalty;
+    auto c = [&](int a, int j) { return cT[(size_t) j*(m + 1) + a]; };
+
+    vector<double> flow((size_t) (m + 1)*nC, 0.0); // flow[a*nC + j]
+    vector<vector<int>> served(m + 1);            // customers with flow at a (maybe stale)
+    vector<char> listed((size_t) (m + 1)*nC, 0);  // k is in served[a]
+    vector<double> residual(m + 1), h(m + 1, 0.0), dist(m + 1);
+    vector<int> prevFac(m + 1), prevCus(m + 1);
+    vector<char> done(m + 1);
+    for (int a = 0; a < m; a++)
+        residual[a] = s[open[a]];
+    residual[u] = INFINITY;
+
+    typedef pair<double, int> ITEM;
+    for (int j = 0; j < nC; j++)
+    {
+        double left = d[j];
+        while (left > epsi)
+        {
+            priority_queue<ITEM, vector<ITEM>, greater<ITEM>> heap;
+            for (int a = 0; a <= m; a++)
+            {
+                dist[a]    = c(a, j) - h[a];
+                prevFac[a] = -1;
+                prevCus[a] = j;
+                done[a]    = 0;
+                heap.push(ITEM(dist[a], a));
+            }
+            int t = -1;
+            while (!heap.empty())
+            {
+                int a = heap.top().second;
+                double da = heap.top().first;
+                heap.pop();
+                if (done[a] || da > dist[a])
+                    continue;
+                done[a] = 1;
+                if (residual[a] > epsi)
+                {
+                    t = a;
+                    break;
+                }
+                // move demand of a customer k served by a to another facility b
+                vector<int> & list = served[a];
+                unsigned kept = 0;
+                for (unsigned q = 0; q < list.size(); q++)
+                {
+                    int k = list[q];
+                    if (flow[(size_t) a*nC + k] <= epsi)
+                    {
+                        listed[(size_t) a*nC + k] = 0;
+                        continue;
+                    }
+                    list[kept++] = k;
+                    const double * ck = &cT[(size_t) k*(m + 1)];
+                    double base = dist[a] - ck[a] + h[a];
+                    for (int b = 0; b <= m; b++)
+                    {
+                        double nd = base + ck[b] - h[b];
+                        if (!done[b] && nd < dist[b])
+                        {
+                            dist[b]    = nd;
+                            prevFac[b] = a;
+                            prevCus[b] = k;
+                            heap.push(ITEM(nd, b));
+                        }
+                    }
+                }
+                list.resize(kept);
+            }
+
+            // bottleneck of the path t <- ... <- j, and augmentation
+            double delta = min(left, residual[t]);
+            for (int b = t; prevFac[b] >= 0; b = prevFac[b])
+                delta = min(delta, flow[(size_t) prevFac[b]*nC + prevCus[b]]);
+            for (int b = t; b >= 0; b = prevFac[b])
+            {
+                int k = prevCus[b];
+                if (!listed[(size_t) b*nC + k])
+                {
+                    served[b].push_back(k);
+                    listed[(size_t) b*nC + k] = 1;
+                }
+                flow[(size_t) b*nC + k] += delta;
+                if (prevFac[b] >= 0)
+                    flow[(size_t) prevFac[b]*nC + k] -= delta;
+            }
+            residual[t] -= delta;
+            left        -= delta;
+            for (int a = 0; a <= m; a++)
+                h[a] += min(dist[a], dist[t]);
+        }
+    }
+
+    double total = 0.0;
+    for (int a = 0; a < m; a++)
+        for (int k : served[a])
+            if (flow[(size_t) a*nC + k] > epsi)
+                total += cost[a][k]*flow[(size_t) a*nC + k];
+    unmet    = 0.0;
+    unmetMax = 0.0;
+    for (int k : served[u])
+        if (flow[(size_t) u*nC + k] > epsi)
+        {
+            unmet   += flow[(size_t) u*nC + k];
+            unmetMax = max(unmetMax, flow[(size_t) u*nC + k]);
+        }
+    return total;
+}
+
+/// Single-source reallocation (see the description of the file)
+/**
+ * `planned[j]` is the facility (index in `open`) planned for customer `j`,
+ * or -1. Overloaded facilities are repaired by moving the customer with the
+ * cheapest move to a facility with enough residual capacity; a customer
+ * that fits nowhere is left unserved. Then customers are moved to cheaper
+ * facilities with enough residual capacity, and unserved customers are
+ * inserted where they fit, until nothing changes.
+ *
+ * Returns the allocation cost; `unmet` and `unmetMax` are the total demand
+ * and the largest demand of the unserved customers.
+ */
+double recourse_assignment(vector<int> & open, int nC, const double * s, const double * d,
+                           vector<const double *> & cost, vector<int> & planned,
+                           double & unmet, double & unmetMax)
+{
+    int m = open.size();
+    vector<int> at(nC, -1);
+    vector<double> residual(m);
+    for (int a = 0; a < m; a++)
+        residual[a] = s[open[a]];
+    for (int j = 0; j < nC; j++)
+    {
+        at[j] = planned[j];
+        if (at[j] < 0)
+            for (int a = 0; a < m; a++)
+                if (at[j] < 0 || cost[a][j] < cost[at[j]][j])
+                    at[j] = a;
+        if (at[j] >= 0)
+            residual[at[j]] -= d[j];
+    }
+
+    // repair: no facility is overloaded
+    for (int a = 0; a < m; a++)
+        while (residual[a] < -FLOW_EPSI*max(1.0, s[open[a]]))
+        {
+            int bestJ = -1, bestB = -1, bigJ = -1;
+            double bestDelta = INFINITY;
+            for (int j = 0; j < nC; j++)
+            {
+                if (at[j] != a)
+                    continue;
+                if (bigJ < 0 || d[j] > d[bigJ])
+                    bigJ = j;
+                for (int b = 0; b < m; b++)
+                    if (b != a && residual[b] >= d[j]
+                        && (cost[b][j] - cost[a][j])*d[j] < bestDelta)
+                    {
+                        bestDelta = (cost[b][j] - cost[a][j])*d[j];
+                        bestJ     = j;
+                        bestB     = b;
+                    }
+            }
+            if (bestJ < 0) // no move: the largest customer is not served
+            {
+                bestJ = bigJ;
+                bestB = -1;
+            }
+            residual[a] += d[bestJ];
+            at[bestJ]    = bestB;
+            if (bestB >= 0)
+                residual[bestB] -= d[bestJ];
+        }
+
+    // improvement, and insertion of the customers not served
+    for (bool changed = true; changed; )
+    {
+        changed = false;
+        for (int j = 0; j < nC; j++)
+        {
+            int best = at[j];
+            for (int b = 0; b < m; b++)
+                if (b != at[j] && residual[b] >= d[j]
+                    && (best < 0 || cost[b][j] < cost[best][j]))
+                    best = b;
+            if (best == at[j])
+                continue;
+            if (at[j] >= 0)
+                residual[at[j]] += d[j];
+            residual[best] -= d[j];
+            at[j]   = best;
+            changed = true;
+        }
+    }
+
+    double total = 0.0;
+    unmet    = 0.0;
+    unmetMax = 0.0;
+    for (int j = 0; j < nC; j++)
+        if (at[j] >= 0)
+            total += cost[at[j]][j]*d[j];
+        else
+        {
+            unmet   += d[j];
+            unmetMax = max(unmetMax, d[j]);
+        }
+    return total;
+}
@@ -61,6 +61,7 @@ ILOSTLBEGIN
 
 /* #include "timer.h" */
 #include "options_sg.h"
+#include "writer_sg.h"
 
 using namespace std;
 
@@ -88,7 +89,8 @@ struct INSTANCE {
     double  *f;    //!< Fixed costs
     double  *s;    //!< Capacity
     double  *d;    //!< Demand
-    double **c;    //!< Allocation costs
+    double **c;    //!< Allocation costs (rows of one contiguous block)
+    double  *cT;   //!< Allocation costs, customer-major (cT[j*nF+i])
     double   totS; //!< Total supply
     double   totD; //!< Total demand
 
@@ -132,7 +134,7 @@ int timeLimit;
 
 /****************** FUNCTIONS DECLARATION ***************************/
 int readProblemData(char * _FILENAME, int fType, INSTANCE & inp);
-void printOptions(char * _FILENAME, INSTANCE inp, int timeLimit);
+void printOptions(char * _FILENAME, INSTANCE & inp, int timeLimit);
 void GenerateDemand(int ind_seed);
 /****************** FUNCTIONS DECLARATION ***************************/
 
@@ -166,7 +168,7 @@ void GenerateDemand(int ind_seed){
         s1              = s1.substr(s1.find_last_of("\\/"), 100);
         string filename = "scenarios"+s1 + "_" + to_string((int)(_epsilon*1000)) +"_" + to_string(ind_seed) + ".box"; 
 
-	ofstream fWriter(filename, ios::out);
+	WRITER fWriter(filename); // buffered (see writer_sg.cpp)
 
 	cout <<filename<< endl;
 	
@@ -178,8 +180,8 @@ void GenerateDemand(int ind_seed){
 	double somma_base = 0.0;
 	double somma_nuovo = 0.0;
         //fWriter << filename<<endl;
-        fWriter << inp.nF <<" "<< inp.nC<< endl;
-        for (int i = 0; i < inp.nF; i++) fWriter << inp.s[i] <<" "<< inp.f[i]<< endl;
+        fWriter << inp.nF <<' '<< inp.nC<< '\n';
+        for (int i = 0; i < inp.nF; i++) fWriter << inp.s[i] <<' '<< inp.f[i]<< '\n';
 	double * domanda_temp =new double[inp.nC];
 	mt19937 mt_rand(ind_seed);
         for (int j = 0; j < inp.nC; j++){
@@ -199,7 +201,7 @@ void GenerateDemand(int ind_seed){
 		
 
 		//cout<< "inp.d[j] = " << inp.d[j] << " base_demand =" << base_demand << " coef = " << coef << " base_demand*coef = " << base_demand*coef << endl; 
-		fWriter << new_dem<<" ";
+		fWriter << new_dem<<' ';
 		domanda_temp[j]=new_dem;
 
 		somma_base+=base_demand;
@@ -209,12 +211,11 @@ void GenerateDemand(int ind_seed){
 
 	cout << "somma_base = "<< somma_base << " somma_nuovo = " <<somma_nuovo << " ratio = " << somma_base/somma_nuovo << endl;
 	
-        fWriter<< endl;
+        fWriter<< '\n';
 
-        for (int i = 0; i < inp.nF; i++){
-            for (int j = 0; j < inp.nC; j++) fWriter << inp.c[i][j]*domanda_temp[j]<<" ";
-		fWriter<< endl;
-        }
+        // cost matrix: rows formatted in parallel (see write_matrix())
+        write_matrix(fWriter, inp.nF, inp.nC,
+                     [&](int i, int j) { return inp.c[i][j]*domanda_temp[j]; });
 
     }
     // read Avella instances
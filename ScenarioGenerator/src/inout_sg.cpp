@@ -22,6 +22,7 @@
  * * Read nominal instance from disk (both OR Library and Avella). See the
  *   introduction part of rcflp.cpp to see how the costs \f$c_{ij}\f$ are
  *   managed in the two instance types.
+ * * Map nominal instances stored in binary format. See readBinaryProblemData()
  * * Read parameters for the different support sets. Currently, we read
  *   parameters for the following sets:
  *   * Ellipsoidal support set. See read_parameters_ellipsoidal()
@@ -35,6 +36,11 @@
 #include <iomanip>
 #include <cstdlib>
 #include <fstream>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
 
 
@@ -48,6 +54,7 @@ struct INSTANCE { /// See same data structure define in rcflp.cpp
     double  *s;
     double  *d;
     double **c;
+    double  *cT;   // costs in customer-major format (cT[j*nF+i])
     double   totS;
     double   totD;
 
@@ -64,16 +71,145 @@ extern int _seed;
 extern int _quantity;
 
 
+/// Header of the binary instance format (see readBinaryProblemData())
+struct BINHEADER {
+    char   magic[8];   //!< "RCFLPBIN"
+    int    version;    //!< format version (currently 1)
+    int    fType;      //!< type of the text instance it was converted from (1-2)
+    int    nF;         //!< number of facilities
+    int    nC;         //!< number of customers
+    double totS;       //!< total supply
+    double totD;       //!< total demand
+    char   pad[24];    //!< padding to 64 bytes
+};
+const char BINMAGIC[8] = {'R','C','F','L','P','B','I','N'};
+const int  BINVERSION  = 1;
+const long BINALIGN    = 64; //!< every array starts on a 64-byte boundary
+
+/// Offsets (in bytes) of the arrays f, s, d and c in a binary instance file.
+/** The last element of `off` is the total size of the file. */
+void binary_offsets(int nF, int nC, long off[5])
+{
+    long n[4] = {(long)nF, (long)nF, (long)nC, (long)nF*(long)nC};
+    off[0] = sizeof(BINHEADER);
+    for (int k = 0; k < 4; k++)
+    {
+        off[k] = (off[k] + BINALIGN - 1)/BINALIGN*BINALIGN;
+        off[k+1] = off[k] + n[k]*(long)sizeof(double);
+    }
+}
+
+/// Check whether a file is an instance in binary format (by its magic number).
+bool isBinaryInstance(char * _FILENAME)
+{
+    char magic[8];
+    ifstream fReader(_FILENAME, ios::in | ios::binary);
+    if (!fReader || !fReader.read(magic, 8))
+        return false;
+    return memcmp(magic, BINMAGIC, 8) == 0;
+}
+
+/// Read an instance stored in binary format.
+/**
+ * The file is produced by the InstanceConverter tool and contains a
+ * BINHEADER followed by the arrays f[nF], s[nF], d[nC] and c[nF*nC]. The
+ * costs are stored row by row (facility-major) and are already the unit
+ * costs used internally, i.e., OR Library costs are divided by \f$d_j\f$.
+ *
+ * The file is mapped in memory (`mmap`) instead of being read, and the
+ * instance arrays point directly into the mapping. The mapping is private
+ * and read-only in practice: all the processes loading the same file share
+ * the pages of the page cache, and no copy of the cost matrix is made.
+ */
+int readBinaryProblemData(char * _FILENAME, INSTANCE & inp)
+{
+    int fd = open(_FILENAME, O_RDONLY);
+    if (fd < 0)
+    {
+        cout << "cannot open file " << _FILENAME << endl;
+        exit(1);
+    }
+    struct stat st;
+    fstat(fd, &st);
+    if ((size_t)st.st_size < sizeof(BINHEADER))
+    {
+        cout << "Binary instance " << _FILENAME << " is truncated." << endl;
+        exit(1);
+    }
+    // private mapping: pages are shared until (if ever) somebody writes them
+    char * base = (char *) mmap(NULL, st.st_size, PROT_READ | PROT_WRITE,
+                                MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED)
+    {
+        cout << "cannot map file " << _FILENAME << endl;
+        exit(1);
+    }
+
+    BINHEADER * head = (BINHEADER *) base;
+    long off[5];
+    binary_offsets(head->nF, head->nC, off);
+    if (memcmp(head->magic, BINMAGIC, 8) != 0 || head->version != BINVERSION
+        || head->nF <= 0 || head->nC <= 0 || off[4] > (long)st.st_size)
+    {
+        cout << "Binary instance " << _FILENAME << " is corrupted." << endl;
+        exit(1);
+    }
+
+    inp.nF   = head->nF;
+    inp.nC   = head->nC;
+    inp.totS = head->totS;
+    inp.totD = head->totD;
+    inp.f    = (double *) (base + off[0]);
+    inp.s    = (double *) (base + off[1]);
+    inp.d    = (double *) (base + off[2]);
+    inp.c    = new double*[inp.nF];
+    for (int i = 0; i < inp.nF; i++)
+        inp.c[i] = (double *) (base + off[3]) + (long)i*inp.nC;
+
+    return head->fType;
+}
+
+/// Allocate the cost matrix as a single aligned block.
+/**
+ * The costs are stored row by row (facility-major) in one contiguous buffer
+ * aligned to BINALIGN bytes, and `c[i]` points to the beginning of row `i`.
+ * Loops over \f$c_{ij}\f$ thus run over consecutive memory, and the layout
+ * is the same as the one used in the binary format.
+ */
+void allocate_costs(INSTANCE & inp)
+{
+    size_t bytes = ((size_t)inp.nF*inp.nC*sizeof(double) + BINALIGN - 1)/BINALIGN*BINALIGN;
+    double * buffer = (double *) aligned_alloc(BINALIGN, bytes);
+    inp.c = new double*[inp.nF];
+    for (int i = 0; i < inp.nF; i++)
+        inp.c[i] = buffer + (long)i*inp.nC;
+}
+
 /// Read benchmark instances
 /**
  * Currently, two types of instances can be imported:
  * type 1: OR Library
  * type 2: Avella (Test Bed 1, Test Bed A. Test Bed B)
+ *
+ * Instances converted to the binary format (see readBinaryProblemData()) are
+ * recognized automatically and are mapped in memory instead of being parsed.
  */
 int readProblemData(char * _FILENAME, int fType, INSTANCE & inp)
 {
     inp.totS = 0.0;
+    inp.cT   = NULL;
     inp.totD = 0.0;
+    // binary instances are recognized by their header, whatever the -t flag
+    if (isBinaryInstance(_FILENAME))
+    {
+        int binType = readBinaryProblemData(_FILENAME, inp);
+        if (binType != fType)
+            cout << "[** Binary instance converted from type " << binType
+                 << ", but -t " << fType << " was given]" << endl;
+        return 1;
+    }
+
     ifstream fReader(_FILENAME, ios::in);
     if (!fReader)
     {
@@ -88,9 +224,7 @@ int readProblemData(char * _FILENAME, int fType, INSTANCE & inp)
         inp.s = new double[inp.nF];
         inp.f = new double[inp.nF];
         inp.d = new double[inp.nC];
-        inp.c = new double*[inp.nF];
-        for (int i = 0; i < inp.nF; i++)
-            inp.c[i] = new double[inp.nC];
+        allocate_costs(inp);
 
         for (int i = 0; i < inp.nF; i++)
         {
@@ -120,9 +254,7 @@ int readProblemData(char * _FILENAME, int fType, INSTANCE & inp)
         inp.f = new double[inp.nF];
         inp.s = new double[inp.nF];
         inp.d = new double[inp.nC];
-        inp.c = new double*[inp.nF];
-        for (int i = 0; i < inp.nF; i++)
-            inp.c[i] = new double[inp.nC];
+        allocate_costs(inp);
         for (int j = 0; j < inp.nC; j++)
         {
             fReader >> inp.d[j];
@@ -148,7 +280,7 @@ int readProblemData(char * _FILENAME, int fType, INSTANCE & inp)
     return 1;
 }
 
-void printOptions(char * _FILENAME, INSTANCE inp, int timeLimit)
+void printOptions(char * _FILENAME, INSTANCE & inp, int timeLimit)
 {
    cout << "-------------------------------------" << endl;
    cout << "- OPTIONS : " << endl;
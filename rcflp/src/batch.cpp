@@ -0,0 +1,319 @@
+/***************************************************************************
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+/*! \file batch.cpp
+  \brief Batch of jobs solved by a pool of worker processes (flag -q).
+
+ * The manifest given with **-q** has one job per line, written as the
+ * options of a single run (e.g., `-i cap41 -t 1 -v 4 -u 2 -l 600`); empty
+ * lines and lines starting with `#` are ignored. Job \f$k\f$ (the \f$k\f$-th
+ * job of the manifest, from 1) runs in the directory `job-k` of the output
+ * directory given with **-O** (default `batch`), where its log (`log.txt`)
+ * and all its output files are written. Relative paths of existing files in
+ * the job line are made absolute first, and the folders `parameters` and
+ * `support` of the directory of the driver are linked in `job-k`, since the
+ * parameters of the supports and the sets \f$B_l\f$ are read and written
+ * there with relative paths (see read_parameters_box() and
+ * save_instance_2_disk()).
+ *
+ * Up to **-N** jobs run at the same time, each in a child process (fork) of
+ * the driver, which has not read any instance: a job only pays for reading
+ * its instance and for its own cplex environment, but not for starting a new
+ * program. The driver:
+ * - skips the jobs with a `done` file in their directory, written when a
+ *   previous run of the manifest completed a job with the same options at
+ *   the same position (a job moved, added or removed in the manifest is run
+ *   again);
+ * - starts the jobs with the longest expected time first, i.e., the largest
+ *   instance files (weighted by the version: the polyhedral model is the
+ *   largest), with ties broken by the time limit;
+ * - gives each job the time limit of the driver (**-l**), unless the job line
+ *   has its own; a job still running after twice its limit plus one minute
+ *   (e.g., stuck in the model build) is killed;
+ * - writes `results.csv` in the output directory, with one line per job
+ *   (status, wall time and the line of its `solution.txt`).
+ */
+
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <cstdlib>
+#include <cstring>
+#include <climits>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <chrono>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <signal.h>
+
+#include "options.h"
+
+using namespace std;
+
+extern int timeLimit;
+
+int solve_instance();
+
+
+struct JOB {
+    int            id;        //!< position in the manifest (from 1)
+    vector<string> args;      //!< options of the job
+    string         dir;       //!< output directory of the job
+    double         expected;  //!< expected effort (used to order the jobs)
+    int            limit;     //!< time limit (seconds)
+    string         status;    //!< done, failed, killed or skipped
+    double         wall;      //!< wall-clock time (seconds)
+    pid_t          pid;
+    chrono::system_clock::time_point start;
+};
+
+/// Options of a job, in one line (written in its `done` file and in results.csv)
+string batch_options(JOB & job)
+{
+    string options;
+    for (unsigned t = 0; t < job.args.size(); t++)
+        options += (t > 0 ? " " : "") + job.args[t];
+    return options;
+}
+
+/// Read the jobs of the manifest. Returns false if the file cannot be read.
+bool batch_read_manifest(char * _MANIFEST, char * _BATCHDIR, vector<JOB> & jobs)
+{
+    ifstream fReader(_MANIFEST, ios::in);
+    if (!fReader)
+    {
+        cout << "Cannot open manifest file " << _MANIFEST << endl;
+        return false;
+    }
+
+    string line;
+    while (getline(fReader, line))
+    {
+        istringstream tokens(line);
+        JOB job;
+        string tok;
+        while (tokens >> tok)
+        {
+            // relative paths of existing files are made absolute (jobs run in their directory)
+            char * full;
+            if (tok[0] != '-' && tok[0] != '/' && access(tok.c_str(), F_OK) == 0
+                && (full = realpath(tok.c_str(), NULL)) != NULL)
+            {
+                tok = full;
+                free(full);
+            }
+            job.args.push_back(tok);
+        }
+        if (job.args.empty() || job.args[0][0] == '#')
+            continue;
+
+        job.id       = jobs.size() + 1;
+        job.dir      = string(_BATCHDIR) + "/job-" + to_string(job.id);
+        job.limit    = timeLimit;
+        job.expected = 0.0;
+        job.wall     = 0.0;
+        job.pid      = 0;
+        int version  = 1;
+        for (unsigned k = 0; k + 1 < job.args.size(); k++)
+        {
+            struct stat st;
+            if (job.args[k] == "-l")
+                job.limit = atol(job.args[k+1].c_str());
+            else if (job.args[k] == "-v")
+                version = atol(job.args[k+1].c_str());
+            else if (job.args[k] == "-i" && stat(job.args[k+1].c_str(), &st) == 0)
+                job.expected = st.st_size;
+        }
+        job.expected *= (version == 4) ? 4.0 : (version == 3) ? 2.0 : 1.0;
+        jobs.push_back(job);
+    }
+    fReader.close();
+    return true;
+}
+
+/// Run one job in the child process (never returns)
+void batch_child(JOB & job)
+{
+    char * home = getcwd(NULL, 0); // directory of the driver
+    if (home == NULL || chdir(job.dir.c_str()) != 0 || freopen("log.txt", "w", stdout) == NULL)
+        _exit(2);
+    dup2(fileno(stdout), fileno(stderr));
+
+    // input folders of the driver (see the description of the file)
+    const char * shared[] = {"parameters", "support"};
+    for (const char * f : shared)
+    {
+        string target = string(home) + "/" + f;
+        struct stat st;
+        if (stat(target.c_str(), &st) == 0 && lstat(f, &st) != 0)
+            if (symlink(target.c_str(), f) != 0)
+                cout << "Cannot link folder '" << target << "'." << endl;
+    }
+    free(home);
+
+    // output folders of a single run (see writeSolution() and the reports); a
+    // support folder only if the driver has none, so that B_l is not lost
+    const char * folders[] = {"solutions", "models", "sweep", "scaling", "benders", "linking",
+                              "support"};
+    for (const char * f : folders)
+        mkdir(f, 0755);
+
+    vector<char *> argv;
+    string prog = "rcflp";
+    string lim  = to_string(timeLimit);
+    argv.push_back(&prog[0]);
+    argv.push_back((char *) "-l");
+    argv.push_back(&lim[0]);
+    for (unsigned k = 0; k < job.args.size(); k++)
+        argv.push_back(&job.args[k][0]);
+    argv.push_back(NULL);
+
+    int err = parseOptions(argv.size() - 1, argv.data());
+    int rc  = (err != 0) ? 1 : solve_instance();
+    cout.flush();
+    fflush(stdout);
+    _exit(rc);
+}
+
+/// Write the consolidated results file of the batch
+void batch_results(char * _BATCHDIR, vector<JOB> & jobs)
+{
+    string filename = string(_BATCHDIR) + "/results.csv";
+    ofstream fWriter(filename, ios::out);
+    fWriter << "job;status;wall;options;instance;type;version;support;z;zStatus;time;"
+            << "Omega;epsilon;delta;gamma;L" << endl;
+    for (unsigned k = 0; k < jobs.size(); k++)
+    {
+        string options = batch_options(jobs[k]);
+        string sol;
+        ifstream fReader(jobs[k].dir + "/solution.txt", ios::in);
+        if (fReader && getline(fReader, sol))
+            replace(sol.begin(), sol.end(), '\t', ';');
+        fWriter << jobs[k].id << ";" << jobs[k].status << ";" << setprecision(6)
+                << jobs[k].wall << ";" << options << ";" << sol << endl;
+    }
+    fWriter.close();
+    cout << "Batch results written to disk. ('" << filename << "')" << endl;
+}
+
+/// Solve the jobs of the manifest with nWorkers processes (flag -q)
+int batch_run(char * _MANIFEST, int nWorkers, char * _BATCHDIR)
+{
+    vector<JOB> jobs;
+    if (!batch_read_manifest(_MANIFEST, _BATCHDIR, jobs))
+        return 1;
+    mkdir(_BATCHDIR, 0755);
+    nWorkers = max(1, nWorkers);
+
+    // pending jobs, longest expected first
+    vector<int> queue;
+    for (unsigned k = 0; k < jobs.size(); k++)
+    {
+        mkdir(jobs[k].dir.c_str(), 0755);
+        string doneFile = jobs[k].dir + "/done", options;
+        ifstream fDone(doneFile, ios::in);
+        double wall;
+        if (fDone >> wall && getline(fDone >> ws, options) && options == batch_options(jobs[k]))
+        {
+            jobs[k].status = "skipped";
+            jobs[k].wall   = wall;
+        }
+        else
+        {
+            unlink(doneFile.c_str()); // another job was done at this position
+            queue.push_back(k);
+        }
+    }
+    stable_sort(queue.begin(), queue.end(), [&](int a, int b) {
+        if (jobs[a].expected != jobs[b].expected)
+            return jobs[a].expected > jobs[b].expected;
+        return jobs[a].limit > jobs[b].limit;
+    });
+    cout << "[** Batch :: " << jobs.size() << " jobs (" << jobs.size() - queue.size()
+         << " already completed); " << nWorkers << " workers]" << endl;
+
+    auto start = chrono::system_clock::now();
+    unsigned next = 0;
+    int nRunning  = 0;
+    cout.flush();
+    while (next < queue.size() || nRunning > 0)
+    {
+        while (nRunning < nWorkers && next < queue.size())
+        {
+            JOB & job = jobs[queue[next++]];
+            job.start = chrono::system_clock::now();
+            job.pid   = fork();
+            if (job.pid < 0)
+            {
+                cout << "[** Batch :: cannot fork job " << job.id << "]" << endl;
+                job.status = "failed";
+                continue;
+            }
+            if (job.pid == 0)
+                batch_child(job);
+            nRunning++;
+            cout << "[** Batch :: job " << job.id << " started (pid " << job.pid << ")]" << endl;
+        }
+
+        int   status;
+        pid_t pid = waitpid(-1, &status, WNOHANG);
+        if (pid <= 0)
+        {
+            // kill the jobs far beyond their time limit
+            for (unsigned k = 0; k < jobs.size(); k++)
+                if (jobs[k].pid > 0 && chrono::duration<double>(chrono::system_clock::now()
+                                       - jobs[k].start).count() > 2.0*jobs[k].limit + 60)
+                {
+                    kill(jobs[k].pid, SIGKILL);
+                    jobs[k].status = "killed";
+                }
+            sleep(1);
+            continue;
+        }
+
+        for (unsigned k = 0; k < jobs.size(); k++)
+            if (jobs[k].pid == pid)
+            {
+                JOB & job = jobs[k];
+                job.pid  = 0;
+                job.wall = chrono::duration<double>(chrono::system_clock::now()-job.start).count();
+                if (job.status != "killed")
+                    job.status = (WIFEXITED(status) && WEXITSTATUS(status) == 0) ? "done" : "failed";
+                if (job.status == "done")
+                {
+                    ofstream fDone(job.dir + "/done", ios::out);
+                    fDone << job.wall << endl << batch_options(job) << endl;
+                    fDone.close();
+                }
+                nRunning--;
+                cout << "[** Batch :: job " << job.id << " " << job.status << " in "
+                     << setprecision(4) << job.wall << " s]" << setprecision(6) << endl;
+            }
+    }
+
+    batch_results(_BATCHDIR, jobs);
+    int nFailed = count_if(jobs.begin(), jobs.end(),
+                           [](const JOB & j) { return j.status == "failed" || j.status == "killed"; });
+    cout << "[** Batch :: completed in " << setprecision(4)
+         << chrono::duration<double>(chrono::system_clock::now()-start).count() << " s; "
+         << nFailed << " failed]" << setprecision(6) << endl;
+    return nFailed > 0 ? 1 : 0;
+}
@@ -0,0 +1,401 @@
+/***************************************************************************
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+/*! \file candidates.cpp
+  \brief Sparse allocation variables (candidate lists) with pricing.
+
+ * Activated with the command line flag **-k K**, for the multi-source
+ * (-v 2) and the dualized polyhedral (-v 4) models, with the Concert builder.
+ * The model is built only with the allocation variables \f$x_{ij}\f$ of the
+ * \f$K\f$ cheapest facilities of each customer (plus those used by the MIP
+ * starts): the other \f$x_{ij}\f$ are never extracted, and their linking
+ * rows are not created (see isCandidate()).
+ *
+ * Before the MIP, a pricing loop (see solveCandidateProblem()) solves the LP
+ * relaxation of the restricted model and adds every missing \f$x_{ij}\f$ with
+ * negative reduced cost, until there is none: the LP relaxation of the
+ * restricted model is then the one of the full model (same bound). The
+ * reduced cost is computed from the duals of the rows in which
+ * \f$x_{ij}\f$ would appear:
+ * * MS model: \f$\bar{c}_{ij} = d_jc_{ij} - \pi_j - d_j\mu_i\f$ (demand and
+ *   capacity rows);
+ * * dualized model: \f$\bar{c}_{ij} = - \pi_j + \sigma_{ij} + c_{ij}\rho_j\f$
+ *   (demand, `rob_dem_constr` and `rob_obj` rows).
+ *
+ * The linking row \f$x_{ij} \leq y_i\f$ of a missing variable is added with
+ * the variable (if linking rows are in the model, see linking.cpp), and has
+ * a zero dual. If the restricted LP is infeasible, the lists are enlarged
+ * (2K, 4K, ... cheapest facilities). After the MIP, the same pricing is done
+ * on the LP with \f$y\f$ fixed to the incumbent: if a column is added, the
+ * MIP is solved again, starting from the incumbent. Hence, the allocation of
+ * the final solution is optimal for its set of open facilities over all the
+ * \f$x_{ij}\f$.
+ *
+ * This is price-and-branch, not branch-and-price: a column with nonnegative
+ * reduced cost at the root might still improve a solution deep in the tree,
+ * and the MIP optimum of the restricted model is not in itself the one of
+ * the full model. When the MIP is solved to optimality, a certificate step
+ * uses the duals of the last root LP: every solution of value \f$z\f$
+ * satisfies \f$z \geq z_{LP} + \sum \bar{c}_{ij}x_{ij}\f$ over the missing
+ * columns (the terms of the other variables are nonnegative), so a solution cheaper than the
+ * incumbent \f$UB\f$ gives the missing columns a total reduced cost below
+ * \f$G = UB - z_{LP}\f$. Every missing column with \f$\bar{c}_{ij} < G\f$
+ * is added and the MIP is solved again, until there is none. Then no better
+ * solution can move a whole customer to a missing column, but the
+ * allocations are continuous: a fraction of a customer (with total reduced
+ * cost below \f$G\f$) is not ruled out. The optimum is thus certified only
+ * in this sense, and the run says when even this does not hold (MIP not
+ * solved to optimality, or too many rounds).
+ */
+
+#include <ilcplex/ilocplex.h>
+ILOSTLBEGIN
+
+#include <iostream>
+#include <iomanip>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <numeric>
+#include <chrono>
+
+using namespace std;
+
+
+struct INSTANCE { /// See same data structure define in rcflp.cpp
+    int nF;
+    int nC;
+    double  *f;
+    double  *s;
+    double  *d;
+    double **c;
+    double  *cT;   // costs in customer-major format (cT[j*nF+i])
+    double   totS;
+    double   totD;
+
+    int nR;        // number of constraints polyhedron uncertainty set
+    double  *h;    // rhs of polyhedron definining support
+    int     *W;    // matrix W in column major format
+    int *index;    // index of column major format for w
+    int *start;    // starting position for elements of column j
+};
+
+struct SOLUTION { /// See same data structure define in rcflp.cpp
+    int nOpen;
+    int  *ySol;
+    vector<int>    xBeg;  // customer-major sparse allocations (see rcflp.cpp)
+    vector<int>    xFac;
+    vector<double> xVal;
+    double zStar;
+    IloAlgorithm::Status zStatus;
+    IloNum startTime;
+    IloNum cpuTime;
+};
+
+typedef IloArray <IloNumVarArray> TwoD;
+extern TwoD x_ilo;
+extern IloNumVarArray y_ilo;
+extern IloRangeArray demand_ilo;
+extern IloRangeArray cap_ilo;
+extern IloArray<IloRangeArray> rob_dem_ilo;
+extern IloRangeArray rob_obj_ilo;
+extern IloObjective obj_ilo;
+extern IloEnv env;
+extern vector<char> candidate;
+extern int candidateModel;
+extern vector<double> msDemand;
+extern vector<SOLUTION> starts;
+extern int candidateK;
+extern int nThreads;
+extern int solLimit;
+extern int timeLimit;
+extern int displayLimit;
+const double EPSI = 0.00001;
+
+/// Duals of the rows in which a missing \f$x_{ij}\f$ would appear (see candidate_reduced_cost())
+struct PRICING_DUALS {
+    vector<double> piDem;  //!< demand rows
+    vector<double> piRow;  //!< capacity rows (MS), or rob_dem_constr rows (dualized, i*nC+j)
+    vector<double> piObj;  //!< rob_obj rows (dualized)
+};
+
+int solveCplexProblem(IloModel model, IloCplex cplex, INSTANCE & inp, int solLimit, int timeLimit, int displayLimit);
+void linking_add_row(IloModel & model, int i, int j);
+
+
+/// True if \f$x_{ij}\f$ is in the model (always true if there are no candidate lists)
+bool isCandidate(INSTANCE & inp, int i, int j)
+{
+    return candidate.empty() || candidate[(long)i*inp.nC + j];
+}
+
+/// Mark the k cheapest facilities of each customer; returns the customers' new candidates
+/**
+ * If `model` is not NULL, the new candidates are also added to the model
+ * (see candidate_add_column()).
+ */
+long candidate_mark_cheapest(INSTANCE & inp, int k, IloModel * model);
+
+/// Build the candidate lists (flag -k): the k cheapest facilities, plus the MIP starts
+void candidate_lists(INSTANCE & inp, int k)
+{
+    candidate.assign((long)inp.nF*inp.nC, 0);
+    candidate_mark_cheapest(inp, k, NULL);
+    for (int s = 0; s < (int) starts.size(); s++)
+        for (int j = 0; j < inp.nC; j++)
+            for (int p = starts[s].xBeg[j]; p < starts[s].xBeg[j+1]; p++)
+                if (starts[s].xVal[p] > EPSI)
+                    candidate[(long)starts[s].xFac[p]*inp.nC + j] = 1;
+
+    long nCand = count(candidate.begin(), candidate.end(), 1);
+    cout << "[** Candidate lists :: " << nCand << " of " << (long)inp.nF*inp.nC
+         << " allocation variables (" << setprecision(3)
+         << 100.0*nCand/((double)inp.nF*inp.nC) << "%)]" << setprecision(6) << endl;
+}
+
+/// Add \f$x_{ij}\f$ to the demand, capacity/robust and objective rows, with its linking row
+void candidate_add_column(INSTANCE & inp, IloModel & model, int i, int j)
+{
+    candidate[(long)i*inp.nC + j] = 1;
+    demand_ilo[j].setLinearCoef(x_ilo[i][j], 1.0);
+    if (candidateModel == 2)
+    {
+        cap_ilo[i].setLinearCoef(x_ilo[i][j], msDemand[j]);
+        obj_ilo.setLinearCoef(x_ilo[i][j], msDemand[j]*inp.c[i][j]);
+    }
+    else
+    {
+        rob_dem_ilo[i][j].setLinearCoef(x_ilo[i][j], -1.0);
+        rob_obj_ilo[j].setLinearCoef(x_ilo[i][j], -inp.c[i][j]);
+    }
+    linking_add_row(model, i, j);
+}
+
+long candidate_mark_cheapest(INSTANCE & inp, int k, IloModel * model)
+{
+    k = min(k, inp.nF);
+    long nNew = 0;
+    vector<int> fac(inp.nF);
+    for (int j = 0; j < inp.nC; j++)
+    {
+        iota(fac.begin(), fac.end(), 0);
+        nth_element(fac.begin(), fac.begin() + (k-1), fac.end(),
+                    [&](int a, int b) { return inp.c[a][j] < inp.c[b][j]; });
+        for (int t = 0; t < k; t++)
+        {
+            int i = fac[t];
+            if (candidate[(long)i*inp.nC + j])
+                continue;
+            if (model != NULL)
+                candidate_add_column(inp, *model, i, j);
+            else
+                candidate[(long)i*inp.nC + j] = 1;
+            nNew++;
+        }
+    }
+    return nNew;
+}
+
+/// Store the duals of the current LP solution
+void candidate_duals(INSTANCE & inp, IloCplex & cplex, PRICING_DUALS & pi)
+{
+    IloNumArray val(env);
+    cplex.getDuals(val, demand_ilo);
+    pi.piDem.assign(inp.nC, 0.0);
+    for (int j = 0; j < inp.nC; j++)
+        pi.piDem[j] = val[j];
+    if (candidateModel == 2)
+    {
+        cplex.getDuals(val, cap_ilo);
+        pi.piRow.assign(inp.nF, 0.0);
+        for (int i = 0; i < inp.nF; i++)
+            pi.piRow[i] = val[i];
+    }
+    else
+    {
+        cplex.getDuals(val, rob_obj_ilo);
+        pi.piObj.assign(inp.nC, 0.0);
+        for (int j = 0; j < inp.nC; j++)
+            pi.piObj[j] = val[j];
+        pi.piRow.assign((long)inp.nF*inp.nC, 0.0);
+        for (int i = 0; i < inp.nF; i++)
+        {
+            cplex.getDuals(val, rob_dem_ilo[i]);
+            for (int j = 0; j < inp.nC; j++)
+                pi.piRow[(long)i*inp.nC + j] = val[j];
+        }
+    }
+    val.end();
+}
+
+/// Reduced cost of \f$x_{ij}\f$ (see the description of the file)
+double candidate_reduced_cost(INSTANCE & inp, PRICING_DUALS & pi, int i, int j)
+{
+    if (candidateModel == 2)
+        return msDemand[j]*inp.c[i][j] - pi.piDem[j] - msDemand[j]*pi.piRow[i];
+    return -pi.piDem[j] + pi.piRow[(long)i*inp.nC + j] + inp.c[i][j]*pi.piObj[j];
+}
+
+/// Add all the missing columns with reduced cost below `threshold`
+long candidate_price(INSTANCE & inp, IloModel & model, PRICING_DUALS & pi, double threshold)
+{
+    vector<pair<int,int> > cols;
+    for (int i = 0; i < inp.nF; i++)
+        for (int j = 0; j < inp.nC; j++)
+            if (!candidate[(long)i*inp.nC + j]
+                && candidate_reduced_cost(inp, pi, i, j) < threshold)
+                cols.push_back(make_pair(i, j));
+    for (unsigned k = 0; k < cols.size(); k++)
+        candidate_add_column(inp, model, cols[k].first, cols[k].second);
+    return cols.size();
+}
+
+/// Price the LP relaxation (y relaxed, or fixed to yFix), enlarging the lists if it is infeasible
+/**
+ * The LP is solved by a separate cplex object, on a model containing the main
+ * one: the columns added to the main model are seen by both, while the
+ * relaxation and the fixing of y do not touch the model solved by the MIP
+ * (and its incumbent). The duals of the last LP are returned in `pi`, which
+ * is left empty if the LP is infeasible.
+ */
+long candidate_pricing_loop(INSTANCE & inp, IloModel & model, int * yFix, int & k,
+                            int & rounds, double & zLP, PRICING_DUALS & pi)
+{
+    long nAdded = 0;
+    IloModel lpModel(env, "cflp-pricing");
+    lpModel.add(model);
+    IloConversion relax(env, y_ilo, ILOFLOAT);
+    lpModel.add(relax);
+    IloRangeArray fix(env);
+    if (yFix != NULL)
+        for (int i = 0; i < inp.nF; i++)
+            fix.add(y_ilo[i] == (double) yFix[i]);
+    lpModel.add(fix);
+    IloCplex lpCplex(lpModel);
+    lpCplex.setOut(env.getNullStream());
+    lpCplex.setParam(IloCplex::Param::Threads, nThreads);
+
+    while (true)
+    {
+        rounds++;
+        pi.piDem.clear();
+        if (!lpCplex.solve())
+        {
+            if (k >= inp.nF)
+                break;
+            k = min(2*k, inp.nF);
+            nAdded += candidate_mark_cheapest(inp, k, &model);
+            continue;
+        }
+        zLP = lpCplex.getObjValue();
+        candidate_duals(inp, lpCplex, pi);
+        long n = candidate_price(inp, model, pi, -EPSI);
+        nAdded += n;
+        if (n == 0)
+            break;
+    }
+    lpCplex.end();
+    fix.endElements();
+    fix.end();
+    relax.end();
+    lpModel.end();
+    return nAdded;
+}
+
+/// Solve the model with candidate lists: pricing, MIP, check of the incumbent and certificate (flag -k)
+void solveCandidateProblem(IloModel & model, IloCplex & cplex, INSTANCE & inp)
+{
+    auto start = chrono::system_clock::now();
+    int  k = candidateK;
+    int  rounds = 0;
+    double zLP = 0.0;
+    PRICING_DUALS root, pi;
+    long nAdded = candidate_pricing_loop(inp, model, NULL, k, rounds, zLP, root);
+    double zRoot = zLP;
+    cout << "[** Pricing :: " << nAdded << " columns added in " << rounds << " LP rounds; "
+         << "z LP = " << setprecision(15) << zLP << "; " << setprecision(4)
+         << chrono::duration<double>(chrono::system_clock::now()-start).count()
+         << " s]" << setprecision(6) << endl;
+
+    vector<int> ySol(inp.nF);
+    string notCertified = "too many rounds";
+    for (int it = 0; it < 10; it++)
+    {
+        if (solveCplexProblem(model, cplex, inp, solLimit, timeLimit, displayLimit) != 1)
+        {
+            notCertified = "no MIP solution";
+            break;
+        }
+
+        // price the allocation of the incumbent (y fixed)
+        IloNumVarArray startVar(env);
+        IloNumArray    startVal(env);
+        for (int i = 0; i < inp.nF; i++)
+        {
+            ySol[i] = (cplex.getValue(y_ilo[i]) > 0.5) ? 1 : 0;
+            startVar.add(y_ilo[i]);
+            startVal.add(ySol[i]);
+            for (int j = 0; j < inp.nC; j++)
+                if (candidate[(long)i*inp.nC + j])
+                {
+                    startVar.add(x_ilo[i][j]);
+                    startVal.add(cplex.getValue(x_ilo[i][j]));
+                }
+        }
+        rounds = 0;
+        long n = candidate_pricing_loop(inp, model, &ySol[0], k, rounds, zLP, pi);
+        if (n > 0)
+            cout << "[** Pricing :: " << n << " columns added for the incumbent; "
+                 << "solving again]" << endl;
+        else if (cplex.getStatus() != IloAlgorithm::Optimal)
+            notCertified = "the MIP is not solved to optimality";
+        else if (root.piDem.empty())
+            notCertified = "no root duals";
+        else
+        {
+            // certificate (see the description of the file)
+            double gap = cplex.getObjValue() - zRoot;
+            n = candidate_price(inp, model, root, gap);
+            if (n == 0)
+            {
+                notCertified.clear();
+                cout << "[** Pricing :: every missing column has reduced cost at least UB - z LP = "
+                     << gap << " (certificate, see candidates.cpp)]" << endl;
+            }
+            else
+                cout << "[** Pricing :: " << n << " columns with reduced cost below UB - z LP = "
+                     << gap << " added; solving again]" << endl;
+        }
+        if (n > 0)
+        {
+            cplex.addMIPStart(startVar, startVal, IloCplex::MIPStartRepair, "incumbent");
+            nAdded += n;
+        }
+        startVar.end();
+        startVal.end();
+        if (n == 0)
+            break;
+    }
+    if (!notCertified.empty())
+        cout << "[** Pricing :: optimality over all the allocation variables is not certified ("
+             << notCertified << ")]" << endl;
+
+    long nCand = count(candidate.begin(), candidate.end(), 1);
+    cout << "[** Candidate lists :: " << nCand << " of " << (long)inp.nF*inp.nC
+         << " allocation variables in the final model (" << nAdded << " priced)]" << endl;
+}
@@ -0,0 +1,615 @@
+/***************************************************************************
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+/*! \file heuristic.cpp
+  \brief Construction and local search heuristic (ADD/DROP/SWAP).
+
+ * The heuristic is activated with the command line flag **-H**. It works on
+ * the set of open facilities; given this set, the allocation is optimized:
+ * for the multi-source models, the transportation problem is solved exactly
+ * by successive shortest paths (see heur_transportation()), and for the
+ * single-source model customers are allocated greedily (see
+ * heur_allocate()). The steps are:
+ * * construction: facilities are opened by increasing fixed cost per unit
+ *   of capacity, until the allocation is feasible;
+ * * local search: ADD (open a facility), DROP (close a facility) and SWAP
+ *   (close one and open another) moves, with first improvement, until no
+ *   move improves the solution or the time limit is reached (it is
+ *   checked before every move).
+ *
+ * Robustness is taken into account by allocating a worst-case demand:
+ * * nominal models (-v 1 and -v 2): \f$d_j\f$;
+ * * ellipsoidal model (-v 3): \f$d_j + \Omega\epsilon\f$ for the capacity,
+ *   since \f$\|x_{i\cdot}\|_2 \leq \sum_j x_{ij}\f$ (conservative);
+ * * polyhedral model (-v 4): the upper bound \f$\bar{d}_j\f$ of the support
+ *   (see box_worst_case()), for both capacity and cost. Before the model
+ *   is built (flags -H 2 and -F), the support is not drawn yet, and
+ *   \f$d_j(1+\epsilon)\f$ is used.
+ *
+ * Thus, the solution is feasible for the model being solved, and its value
+ * is exact, apart from the budget support, for which it is an upper bound.
+ */
+
+#include <ilcplex/ilocplex.h>
+ILOSTLBEGIN
+
+#include <iostream>
+#include <iomanip>
+#include <cstdlib>
+#include <cmath>
+#include <limits>
+#include <vector>
+#include <algorithm>
+#include <queue>
+#include <functional>
+#include <chrono>
+
+#include "phases.h"
+
+using namespace std;
+
+
+struct INSTANCE { /// See same data structure define in rcflp.cpp
+    int nF;
+    int nC;
+    double  *f;
+    double  *s;
+    double  *d;
+    double **c;
+    double  *cT;   // costs in customer-major format (cT[j*nF+i])
+    double   totS;
+    double   totD;
+
+    int nR;        // number of constraints polyhedron uncertainty set
+    double  *h;    // rhs of polyhedron definining support
+    int     *W;    // matrix W in column major format
+    int *index;    // index of column major format for w
+    int *start;    // starting position for elements of column j
+};
+
+struct SOLUTION { /// See same data structure define in rcflp.cpp
+    int nOpen;
+    int  *ySol;
+    vector<int>    xBeg;  // customer-major sparse allocations (see rcflp.cpp)
+    vector<int>    xFac;
+    vector<double> xVal;
+    double zStar;
+    IloAlgorithm::Status zStatus;
+    IloNum startTime;
+    IloNum cpuTime;
+};
+
+extern double _Omega;
+extern double _epsilon;
+extern double _delta;
+extern double _gamma;
+extern int    L;
+extern double _Omega_input;
+extern double _epsilon_input;
+extern double _delta_input;
+extern double _gamma_input;
+extern int    L_input;
+extern int    version;
+extern int    support;
+const double EPSI  = 0.00001;
+const double INFTY = std::numeric_limits<double>::infinity();
+
+void read_parameters_ellipsoidal();
+void read_parameters_box();
+void read_parameters_budget();
+bool box_worst_case(INSTANCE & inp, vector<double> & dMax);
+void solution_set_x(INSTANCE & inp, SOLUTION & sol, vector<int> & fac, vector<int> & cus,
+                    vector<double> & val);
+
+vector<double> heurDCap;   //!< Demand used in the capacity constraints
+vector<double> heurDCost;  //!< Demand used in the transportation cost
+vector<int>    heurOrder;  //!< Facilities by increasing cost, for each customer
+vector<double> heurResid;  //!< Residual capacity (heur_allocate())
+vector<double> heurRegret; //!< Regret of each customer (heur_allocate())
+vector<int>    heurCust;   //!< Customers by decreasing regret (heur_allocate())
+vector<double> heurCUnit;  //!< Cost per unit of heurDCap, if heurDCost differs (-v 3)
+
+const double FLOW_EPSI = 1e-9; //!< Flows and capacities below FLOW_EPSI * demand are zero
+
+
+/// Read the parameters of the model, without building it (flag -H 2)
+void heuristic_parameters()
+{
+    switch (version)
+    {
+        case 3 :
+            read_parameters_ellipsoidal();
+            if (_Omega_input!=-1) _Omega = _Omega_input;
+            if (_epsilon_input!=-1) _epsilon = _epsilon_input;
+            break;
+        case 4 : // only epsilon is used (see heuristic_solve()): the support is not drawn
+            if (support == 1)
+                read_parameters_box();
+            else
+                read_parameters_budget();
+            if (_epsilon_input!=-1) _epsilon = _epsilon_input;
+            if (_delta_input!=-1) _delta = _delta_input;
+            if (_gamma_input!=-1) _gamma = _gamma_input;
+            if (L_input!=-1) L = L_input;
+            break;
+        default :
+            break;
+    }
+}
+
+/// Optimal multi-source allocation to the open facilities
+/**
+ * Copy of recourse_transportation() of ScenarioEvaluator (see
+ * recourse_se.cpp), which also returns the flows. `open` are the open
+ * facilities, and `cost[a][j]` is the unit cost of customer `j` at facility
+ * `open[a]`. The demand of the customers is routed one customer at a time,
+ * along shortest paths of the residual network (contracted on the
+ * facilities, with potentials and Dijkstra's algorithm), so that the flow
+ * of the routed demand is optimal at every step. The demand that does not
+ * fit goes to a dummy facility of prohibitive cost.
+ *
+ * Returns the allocation cost; `unmet` is the total unmet demand. If `flowOut`
+ * is not NULL, the flows are stored in it (`(*flowOut)[a*nC + j]`).
+ */
+double heur_transportation(vector<int> & open, int nC, const double * s, const double * d,
+                           vector<const double *> & cost, double & unmet,
+                           vector<double> * flowOut)
+{
+    int m = open.size(), u = m; // u: dummy facility of the unmet demand
+    double cMin = INFTY, cMax = -INFTY, dMax = 0.0;
+    for (int a = 0; a < m; a++)
+        for (int j = 0; j < nC; j++)
+        {
+            cMin = min(cMin, cost[a][j]);
+            cMax = max(cMax, cost[a][j]);
+        }
+    for (int j = 0; j < nC; j++)
+        dMax = max(dMax, d[j]);
+    if (m == 0)
+        cMin = cMax = 0.0;
+    // longer than any path through real facilities: only demand that fits nowhere is unmet
+    double penalty = (m + 1)*(cMax - cMin) + fabs(cMax) + 1.0;
+    double epsi    = FLOW_EPSI*max(1.0, dMax);
+    // costs by customer, dummy facility last: the facilities of a customer are contiguous
+    vector<double> cT((size_t) nC*(m + 1));
+    for (int a = 0; a < m; a++)
+        for (int j = 0; j < nC; j++)
+            cT[(size_t) j*(m + 1) + a] = cost[a][j];
+    for (int j = 0; j < nC; j++)
+        cT[(size_t) j*(m + 1) + u] = penalty;
+    auto c = [&](int a, int j) { return cT[(size_t) j*(m + 1) + a]; };
+
+    vector<double> flow((size_t) (m + 1)*nC, 0.0); // flow[a*nC + j]
+    vector<vector<int>> served(m + 1);            // customers with flow at a (maybe stale)
+    vector<char> listed((size_t) (m + 1)*nC, 0);  // k is in served[a]
+    vector<double> residual(m + 1), h(m + 1, 0.0), dist(m + 1);
+    vector<int> prevFac(m + 1), prevCus(m + 1);
+    vector<char> done(m + 1);
+    for (int a = 0; a < m; a++)
+        residual[a] = s[open[a]];
+    residual[u] = INFTY;
+
+    typedef pair<double, int> ITEM;
+    for (int j = 0; j < nC; j++)
+    {
+        double left = d[j];
+        while (left > epsi)
+        {
+            priority_queue<ITEM, vector<ITEM>, greater<ITEM>> heap;
+            for (int a = 0; a <= m; a++)
+            {
+                dist[a]    = c(a, j) - h[a];
+                prevFac[a] = -1;
+                prevCus[a] = j;
+                done[a]    = 0;
+                heap.push(ITEM(dist[a], a));
+            }
+            int t = -1;
+            while (!heap.empty())
+            {
+                int a = heap.top().second;
+                double da = heap.top().first;
+                heap.pop();
+                if (done[a] || da > dist[a])
+                    continue;
+                done[a] = 1;
+                if (residual[a] > epsi)
+                {
+                    t = a;
+                    break;
+                }
+                // move demand of a customer k served by a to another facility b
+                vector<int> & list = served[a];
+                unsigned kept = 0;
+                for (unsigned q = 0; q < list.size(); q++)
+                {
+                    int k = list[q];
+                    if (flow[(size_t) a*nC + k] <= epsi)
+                    {
+                        listed[(size_t) a*nC + k] = 0;
+                        continue;
+                    }
+                    list[kept++] = k;
+                    const double * ck = &cT[(size_t) k*(m + 1)];
+                    double base = dist[a] - ck[a] + h[a];
+                    for (int b = 0; b <= m; b++)
+                    {
+                        double nd = base + ck[b] - h[b];
+                        if (!done[b] && nd < dist[b])
+                        {
+                            dist[b]    = nd;
+                            prevFac[b] = a;
+                            prevCus[b] = k;
+                            heap.push(ITEM(nd, b));
+                        }
+                    }
+                }
+                list.resize(kept);
+            }
+
+            // bottleneck of the path t <- ... <- j, and augmentation
+            double delta = min(left, residual[t]);
+            for (int b = t; prevFac[b] >= 0; b = prevFac[b])
+                delta = min(delta, flow[(size_t) prevFac[b]*nC + prevCus[b]]);
+            for (int b = t; b >= 0; b = prevFac[b])
+            {
+                int k = prevCus[b];
+                if (!listed[(size_t) b*nC + k])
+                {
+                    served[b].push_back(k);
+                    listed[(size_t) b*nC + k] = 1;
+                }
+                flow[(size_t) b*nC + k] += delta;
+                if (prevFac[b] >= 0)
+                    flow[(size_t) prevFac[b]*nC + k] -= delta;
+            }
+            residual[t] -= delta;
+            left        -= delta;
+            for (int a = 0; a <= m; a++)
+                h[a] += min(dist[a], dist[t]);
+        }
+    }
+
+    double total = 0.0;
+    for (int a = 0; a < m; a++)
+        for (int k : served[a])
+            if (flow[(size_t) a*nC + k] > epsi)
+                total += cost[a][k]*flow[(size_t) a*nC + k];
+    unmet = 0.0;
+    for (int k : served[u])
+        if (flow[(size_t) u*nC + k] > epsi)
+            unmet += flow[(size_t) u*nC + k];
+    if (flowOut != NULL)
+    {
+        flowOut->assign(flow.begin(), flow.begin() + (size_t) m*nC);
+        for (double & f : *flowOut)
+            if (f <= epsi)
+                f = 0.0;
+    }
+    return total;
+}
+
+/// Optimal multi-source allocation of the demand heurDCap (see heur_transportation())
+/**
+ * Returns the total cost (fixed plus transportation), or INFTY if the
+ * demand does not fit in the open facilities. If `sol` is not NULL, the
+ * allocation is stored in it.
+ */
+double heur_transport(INSTANCE & inp, vector<char> & open, SOLUTION * sol)
+{
+    vector<int> fac;
+    double cost = 0.0;
+    for (int i = 0; i < inp.nF; i++)
+        if (open[i])
+        {
+            fac.push_back(i);
+            cost += inp.f[i];
+        }
+    if (fac.empty())
+        return INFTY;
+    int m = fac.size();
+    vector<const double *> rows(m);
+    for (int a = 0; a < m; a++)
+        rows[a] = heurCUnit.empty() ? inp.c[fac[a]] : &heurCUnit[(size_t) fac[a]*inp.nC];
+    double unmet;
+    vector<double> flow;
+    cost += heur_transportation(fac, inp.nC, inp.s, heurDCap.data(), rows, unmet,
+                                sol != NULL ? &flow : NULL);
+    if (unmet > EPSI)
+        return INFTY;
+    if (sol == NULL)
+        return cost;
+
+    vector<int>    sFac, sCus;
+    vector<double> sVal;
+    for (int j = 0; j < inp.nC; j++)
+    {
+        if (heurDCap[j] <= 0.0) // no demand: cheapest open facility
+        {
+            const int * ord = heurOrder.data() + (long)j*inp.nF;
+            int k = 0;
+            while (!open[ord[k]])
+                k++;
+            sFac.push_back(ord[k]);
+            sCus.push_back(j);
+            sVal.push_back(1.0);
+            continue;
+        }
+        for (int a = 0; a < m; a++)
+            if (flow[(size_t) a*inp.nC + j] > 0.0)
+            {
+                sFac.push_back(fac[a]);
+                sCus.push_back(j);
+                sVal.push_back(flow[(size_t) a*inp.nC + j]/heurDCap[j]);
+            }
+    }
+    solution_set_x(inp, *sol, sFac, sCus, sVal);
+    return cost;
+}
+
+/// Allocate the customers to the open facilities
+/**
+ * For the multi-source models the allocation is optimal (see
+ * heur_transport()). For the single-source model, it is greedy:
+ * customers are taken by decreasing regret (difference between the
+ * costs of the two cheapest open facilities), and each one is allocated to
+ * its cheapest open facilities with residual capacity. For the single-source
+ * model, the demand is not split. Returns the total cost (fixed plus
+ * transportation), or INFTY if some customer cannot be allocated. If `sol`
+ * is not NULL, the allocation is stored in it.
+ */
+double heur_allocate(INSTANCE & inp, vector<char> & open, SOLUTION * sol)
+{
+    bool singleSource = (version == 1);
+    if (!singleSource)
+        return heur_transport(inp, open, sol);
+    double cost = 0.0;
+    vector<int>    fac, cus;
+    vector<double> val;
+    for (int i = 0; i < inp.nF; i++)
+    {
+        heurResid[i] = open[i] ? inp.s[i] : 0.0;
+        if (open[i])
+            cost += inp.f[i];
+    }
+
+    for (int j = 0; j < inp.nC; j++)
+    {
+        const int * ord = heurOrder.data() + (long)j*inp.nF;
+        int first = -1, second = -1;
+        for (int k = 0; k < inp.nF && second == -1; k++)
+            if (open[ord[k]])
+            {
+                if (first == -1)
+                    first = ord[k];
+                else
+                    second = ord[k];
+            }
+        if (first == -1)
+            return INFTY;
+        heurRegret[j] = (second == -1) ? INFTY : inp.c[second][j] - inp.c[first][j];
+        heurCust[j]   = j;
+    }
+    sort(heurCust.begin(), heurCust.end(),
+         [](int a, int b) { return heurRegret[a] > heurRegret[b]; });
+
+    for (int t = 0; t < inp.nC; t++)
+    {
+        int j = heurCust[t];
+        const int * ord = heurOrder.data() + (long)j*inp.nF;
+        double rem = heurDCap[j];
+        double frac = 1.0;
+        for (int k = 0; k < inp.nF && frac > EPSI; k++)
+        {
+            int i = ord[k];
+            if (!open[i] || (rem > 0.0 && heurResid[i] <= EPSI))
+                continue;
+            double a;
+            if (rem <= 0.0)
+                a = 1.0;
+            else if (singleSource)
+            {
+                if (heurResid[i] < rem - EPSI)
+                    continue;
+                a = 1.0;
+            }
+            else
+                a = min(frac, heurResid[i]/heurDCap[j]);
+            heurResid[i] -= a*heurDCap[j];
+            frac         -= a;
+            cost         += a*inp.c[i][j]*heurDCost[j];
+            if (sol != NULL)
+            {
+                fac.push_back(i);
+                cus.push_back(j);
+                val.push_back(a);
+            }
+        }
+        if (frac > EPSI)
+            return INFTY;
+    }
+    if (sol != NULL)
+        solution_set_x(inp, *sol, fac, cus, val);
+    return cost;
+}
+
+/// Construction and local search; the solution goes in sol (flag -H)
+/**
+ * Returns false if no feasible solution has been found. The local search
+ * stops after `timeLimit` seconds. The time spent is stored in `sol.cpuTime`.
+ */
+bool heuristic_solve(INSTANCE & inp, SOLUTION & sol, double timeLimit)
+{
+    PHASE_TIMER phase("heuristic");
+    auto start = chrono::system_clock::now();
+    auto elapsed = [&]()
+    { return chrono::duration<double>(chrono::system_clock::now()-start).count(); };
+
+    // worst-case demand
+    heurDCap.assign(inp.d, inp.d + inp.nC);
+    heurDCost.assign(inp.d, inp.d + inp.nC);
+    if (version == 3)
+        for (int j = 0; j < inp.nC; j++)
+            heurDCap[j] += _Omega*_epsilon;
+    if (version == 4)
+    {
+        vector<double> dMax(inp.nC, INFTY);
+        if (inp.start != NULL) // support defined with the model
+            box_worst_case(inp, dMax);
+        for (int j = 0; j < inp.nC; j++)
+        {
+            heurDCap[j]  = (dMax[j] < INFTY) ? dMax[j] : inp.d[j]*(1.0+_epsilon);
+            heurDCost[j] = heurDCap[j];
+        }
+    }
+
+    heurOrder.resize((long)inp.nF*inp.nC);
+    vector<int> fac(inp.nF);
+    for (int j = 0; j < inp.nC; j++)
+    {
+        for (int i = 0; i < inp.nF; i++)
+            fac[i] = i;
+        sort(fac.begin(), fac.end(),
+             [&](int a, int b) { return inp.c[a][j] < inp.c[b][j]; });
+        copy(fac.begin(), fac.end(), heurOrder.begin() + (long)j*inp.nF);
+    }
+    heurCUnit.clear();
+    if (heurDCap != heurDCost) // the transportation problem routes heurDCap
+    {
+        heurCUnit.resize((size_t) inp.nF*inp.nC);
+        for (int i = 0; i < inp.nF; i++)
+            for (int j = 0; j < inp.nC; j++)
+                heurCUnit[(size_t) i*inp.nC + j] = (heurDCap[j] > 0.0)
+                    ? inp.c[i][j]*heurDCost[j]/heurDCap[j] : 0.0;
+    }
+    heurResid.resize(inp.nF);
+    heurRegret.resize(inp.nC);
+    heurCust.resize(inp.nC);
+
+    // construction: open by increasing fixed cost per unit of capacity
+    for (int i = 0; i < inp.nF; i++)
+        fac[i] = i;
+    sort(fac.begin(), fac.end(),
+         [&](int a, int b) { return inp.f[a]/inp.s[a] < inp.f[b]/inp.s[b]; });
+    double totDCap = 0.0;
+    for (int j = 0; j < inp.nC; j++)
+        totDCap += heurDCap[j];
+
+    vector<char> open(inp.nF, 0);
+    double cap  = 0.0;
+    double best = INFTY;
+    for (int k = 0; k < inp.nF && best == INFTY; k++)
+    {
+        open[fac[k]] = 1;
+        cap += inp.s[fac[k]];
+        if (cap >= totDCap)
+            best = heur_allocate(inp, open, NULL);
+    }
+    if (best == INFTY)
+    {
+        cout << "[** Heuristic :: no feasible solution found]" << endl;
+        return false;
+    }
+    double zConstr = best;
+
+    // local search: DROP, ADD and SWAP moves (first improvement)
+    long nMoves = 0;
+    bool improved = true;
+    while (improved && elapsed() < timeLimit)
+    {
+        improved = false;
+        for (int i = 0; i < inp.nF && !improved && elapsed() < timeLimit; i++) // DROP
+        {
+            if (!open[i])
+                continue;
+            open[i] = 0;
+            double z = heur_allocate(inp, open, NULL);
+            if (z < best - EPSI)
+            {
+                best = z;
+                improved = true;
+            }
+            else
+                open[i] = 1;
+        }
+        for (int i = 0; i < inp.nF && !improved && elapsed() < timeLimit; i++) // ADD
+        {
+            if (open[i])
+                continue;
+            open[i] = 1;
+            double z = heur_allocate(inp, open, NULL);
+            if (z < best - EPSI)
+            {
+                best = z;
+                improved = true;
+            }
+            else
+                open[i] = 0;
+        }
+        for (int i = 0; i < inp.nF && !improved && elapsed() < timeLimit; i++) // SWAP
+        {
+            if (!open[i])
+                continue;
+            for (int k = 0; k < inp.nF && !improved && elapsed() < timeLimit; k++)
+            {
+                if (open[k])
+                    continue;
+                open[i] = 0;
+                open[k] = 1;
+                double z = heur_allocate(inp, open, NULL);
+                if (z < best - EPSI)
+                {
+                    best = z;
+                    improved = true;
+                }
+                else
+                {
+                    open[i] = 1;
+                    open[k] = 0;
+                }
+            }
+        }
+        if (improved)
+            nMoves++;
+    }
+
+    // store the solution
+    sol.ySol = new int[inp.nF];
+    sol.zStar = heur_allocate(inp, open, &sol);
+    sol.nOpen = 0;
+    for (int i = 0; i < inp.nF; i++)
+    {
+        sol.ySol[i] = open[i];
+        sol.nOpen  += open[i];
+    }
+    if (version == 3) // robust cost term of the ellipsoidal model
+    {
+        double sq = 0.0;
+        for (int j = 0; j < inp.nC; j++)
+            for (int k = sol.xBeg[j]; k < sol.xBeg[j+1]; k++)
+                sq += sol.xVal[k]*sol.xVal[k]*inp.c[sol.xFac[k]][j]*inp.c[sol.xFac[k]][j];
+        sol.zStar += _Omega*_epsilon*sqrt(sq);
+    }
+    sol.zStatus = IloAlgorithm::Feasible;
+    sol.cpuTime = elapsed();
+
+    cout << "[** Heuristic :: z = " << setprecision(15) << sol.zStar
+         << " (construction " << zConstr << "); " << sol.nOpen << " open facilities; "
+         << nMoves << " moves; " << setprecision(4) << elapsed() << " s]"
+         << setprecision(6) << endl;
+    return true;
+}
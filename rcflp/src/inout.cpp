@@ -22,6 +22,7 @@
  * * Read nominal instance from disk (both OR Library and Avella). See the
  *   introduction part of rcflp.cpp to see how the costs \f$c_{ij}\f$ are
  *   managed in the two instance types.
+ * * Map nominal instances stored in binary format. See readBinaryProblemData()
  * * Read parameters for the different support sets. Currently, we read
  *   parameters for the following sets:
  *   * Ellipsoidal support set. See read_parameters_ellipsoidal()
@@ -35,6 +36,16 @@
 #include <iomanip>
 #include <cstdlib>
 #include <fstream>
+#include <algorithm>
+#include <sstream>
+#include <vector>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "phases.h"
 
 using namespace std;
 
@@ -46,6 +57,7 @@ struct INSTANCE { /// See same data structure define in rcflp.cpp
     double  *s;
     double  *d;
     double **c;
+    double  *cT;   // costs in customer-major format (cT[j*nF+i])
     double   totS;
     double   totD;
 
@@ -68,16 +80,146 @@ extern string supportType;
 extern int support;
 
 
+/// Header of the binary instance format (see readBinaryProblemData())
+struct BINHEADER {
+    char   magic[8];   //!< "RCFLPBIN"
+    int    version;    //!< format version (currently 1)
+    int    fType;      //!< type of the text instance it was converted from (1-2)
+    int    nF;         //!< number of facilities
+    int    nC;         //!< number of customers
+    double totS;       //!< total supply
+    double totD;       //!< total demand
+    char   pad[24];    //!< padding to 64 bytes
+};
+const char BINMAGIC[8] = {'R','C','F','L','P','B','I','N'};
+const int  BINVERSION  = 1;
+const long BINALIGN    = 64; //!< every array starts on a 64-byte boundary
+
+/// Offsets (in bytes) of the arrays f, s, d and c in a binary instance file.
+/** The last element of `off` is the total size of the file. */
+void binary_offsets(int nF, int nC, long off[5])
+{
+    long n[4] = {(long)nF, (long)nF, (long)nC, (long)nF*(long)nC};
+    off[0] = sizeof(BINHEADER);
+    for (int k = 0; k < 4; k++)
+    {
+        off[k] = (off[k] + BINALIGN - 1)/BINALIGN*BINALIGN;
+        off[k+1] = off[k] + n[k]*(long)sizeof(double);
+    }
+}
+
+/// Check whether a file is an instance in binary format (by its magic number).
+bool isBinaryInstance(char * _FILENAME)
+{
+    char magic[8];
+    ifstream fReader(_FILENAME, ios::in | ios::binary);
+    if (!fReader || !fReader.read(magic, 8))
+        return false;
+    return memcmp(magic, BINMAGIC, 8) == 0;
+}
+
+/// Read an instance stored in binary format.
+/**
+ * The file is produced by the InstanceConverter tool and contains a
+ * BINHEADER followed by the arrays f[nF], s[nF], d[nC] and c[nF*nC]. The
+ * costs are stored row by row (facility-major) and are already the unit
+ * costs used internally, i.e., OR Library costs are divided by \f$d_j\f$.
+ *
+ * The file is mapped in memory (`mmap`) instead of being read, and the
+ * instance arrays point directly into the mapping. The mapping is private
+ * and read-only in practice: all the processes loading the same file share
+ * the pages of the page cache, and no copy of the cost matrix is made.
+ */
+int readBinaryProblemData(char * _FILENAME, INSTANCE & inp)
+{
+    int fd = open(_FILENAME, O_RDONLY);
+    if (fd < 0)
+    {
+        cout << "cannot open file " << _FILENAME << endl;
+        exit(1);
+    }
+    struct stat st;
+    fstat(fd, &st);
+    if ((size_t)st.st_size < sizeof(BINHEADER))
+    {
+        cout << "Binary instance " << _FILENAME << " is truncated." << endl;
+        exit(1);
+    }
+    // private mapping: pages are shared until (if ever) somebody writes them
+    char * base = (char *) mmap(NULL, st.st_size, PROT_READ | PROT_WRITE,
+                                MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED)
+    {
+        cout << "cannot map file " << _FILENAME << endl;
+        exit(1);
+    }
+
+    BINHEADER * head = (BINHEADER *) base;
+    long off[5];
+    binary_offsets(head->nF, head->nC, off);
+    if (memcmp(head->magic, BINMAGIC, 8) != 0 || head->version != BINVERSION
+        || head->nF <= 0 || head->nC <= 0 || off[4] > (long)st.st_size)
+    {
+        cout << "Binary instance " << _FILENAME << " is corrupted." << endl;
+        exit(1);
+    }
+
+    inp.nF   = head->nF;
+    inp.nC   = head->nC;
+    inp.totS = head->totS;
+    inp.totD = head->totD;
+    inp.f    = (double *) (base + off[0]);
+    inp.s    = (double *) (base + off[1]);
+    inp.d    = (double *) (base + off[2]);
+    inp.c    = new double*[inp.nF];
+    for (int i = 0; i < inp.nF; i++)
+        inp.c[i] = (double *) (base + off[3]) + (long)i*inp.nC;
+
+    return head->fType;
+}
+
+/// Allocate the cost matrix as a single aligned block.
+/**
+ * The costs are stored row by row (facility-major) in one contiguous buffer
+ * aligned to BINALIGN bytes, and `c[i]` points to the beginning of row `i`.
+ * Loops over \f$c_{ij}\f$ thus run over consecutive memory, and the layout
+ * is the same as the one used in the binary format.
+ */
+void allocate_costs(INSTANCE & inp)
+{
+    size_t bytes = ((size_t)inp.nF*inp.nC*sizeof(double) + BINALIGN - 1)/BINALIGN*BINALIGN;
+    double * buffer = (double *) aligned_alloc(BINALIGN, bytes);
+    inp.c = new double*[inp.nF];
+    for (int i = 0; i < inp.nF; i++)
+        inp.c[i] = buffer + (long)i*inp.nC;
+}
+
 /// Read benchmark instances
 /**
  * Currently, two types of instances can be imported:
  * type 1: OR Library
  * type 2: Avella (Test Bed 1, Test Bed A. Test Bed B)
+ *
+ * Instances converted to the binary format (see readBinaryProblemData()) are
+ * recognized automatically and are mapped in memory instead of being parsed.
  */
 int readProblemData(char * _FILENAME, int fType, INSTANCE & inp)
 {
+    PHASE_TIMER phase("read");
     inp.totS = 0.0;
+    inp.cT   = NULL;
     inp.totD = 0.0;
+    // binary instances are recognized by their header, whatever the -t flag
+    if (isBinaryInstance(_FILENAME))
+    {
+        int binType = readBinaryProblemData(_FILENAME, inp);
+        if (binType != fType)
+            cout << "[** Binary instance converted from type " << binType
+                 << ", but -t " << fType << " was given]" << endl;
+        return 1;
+    }
+
     ifstream fReader(_FILENAME, ios::in);
     if (!fReader)
     {
@@ -92,9 +234,7 @@ int readProblemData(char * _FILENAME, int fType, INSTANCE & inp)
         inp.s = new double[inp.nF];
         inp.f = new double[inp.nF];
         inp.d = new double[inp.nC];
-        inp.c = new double*[inp.nF];
-        for (int i = 0; i < inp.nF; i++)
-            inp.c[i] = new double[inp.nC];
+        allocate_costs(inp);
 
         for (int i = 0; i < inp.nF; i++)
         {
@@ -123,9 +263,7 @@ int readProblemData(char * _FILENAME, int fType, INSTANCE & inp)
         inp.f = new double[inp.nF];
         inp.s = new double[inp.nF];
         inp.d = new double[inp.nC];
-        inp.c = new double*[inp.nF];
-        for (int i = 0; i < inp.nF; i++)
-            inp.c[i] = new double[inp.nC];
+        allocate_costs(inp);
         for (int j = 0; j < inp.nC; j++)
         {
             fReader >> inp.d[j];
@@ -151,8 +289,35 @@ int readProblemData(char * _FILENAME, int fType, INSTANCE & inp)
     return 1;
 }
 
+/// Define the customer-major view of the costs.
+/**
+ * Besides the facility-major matrix `c`, loops that run over the facilities
+ * for a fixed customer \f$j\f$ (e.g., the robust objective constraints in
+ * define_POLY_CFLP()) read `cT[j*nF+i]`, i.e., a contiguous column. The copy
+ * is built once, by blocks, so that both matrices are accessed sequentially
+ * most of the time.
+ */
+void define_customer_major(INSTANCE & inp)
+{
+    if (inp.cT != NULL)
+        return;
+
+    const int BLOCK = 64;
+    size_t bytes = ((size_t)inp.nF*inp.nC*sizeof(double) + BINALIGN - 1)/BINALIGN*BINALIGN;
+    inp.cT = (double *) aligned_alloc(BINALIGN, bytes);
+    for (int i0 = 0; i0 < inp.nF; i0 += BLOCK)
+        for (int j0 = 0; j0 < inp.nC; j0 += BLOCK)
+        {
+            int i1 = min(i0 + BLOCK, inp.nF);
+            int j1 = min(j0 + BLOCK, inp.nC);
+            for (int i = i0; i < i1; i++)
+                for (int j = j0; j < j1; j++)
+                    inp.cT[(long)j*inp.nF + i] = inp.c[i][j];
+        }
+}
+
 /// Print instance info and algorithmic parameters.
-void printOptions(char * _FILENAME, INSTANCE inp, int timeLimit)
+void printOptions(char * _FILENAME, INSTANCE & inp, int timeLimit)
 {
    double _epsilon = 0.0;
    double _delta   = 0.0;
@@ -267,3 +432,51 @@ void read_parameters_budget()
 
     fReader.close();
 }
+
+/// Read the points of a parameter sweep (flag -w).
+/**
+ * Each row of the file defines one point, i.e., the values of
+ * `_epsilon`, `_delta`, `_gamma` and `L` (in this order). Rows starting
+ * with '#' are comments. For example:
+ * ~~~
+ * # epsilon delta gamma L
+ * 0.10 0.5 0.2 5
+ * 0.20 0.5 0.2 5
+ * ~~~
+ * Returns the number of points read.
+ */
+int read_sweep_points(char * _SWEEPNAME, vector<double> & eps, vector<double> & del,
+                      vector<double> & gam, vector<int> & ell)
+{
+    ifstream fReader(_SWEEPNAME, ios::in);
+    if (!fReader)
+    {
+        cout << "Cannot open file '" << _SWEEPNAME << "'." << endl;
+        exit(111);
+    }
+    string line;
+    while (getline(fReader, line))
+    {
+        if (line.empty() || line[0] == '#')
+            continue;
+        istringstream row(line);
+        double e, d, g;
+        int    l;
+        if (!(row >> e >> d >> g >> l))
+        {
+            cout << "Wrong row in file '" << _SWEEPNAME << "': " << line << endl;
+            exit(111);
+        }
+        eps.push_back(e);
+        del.push_back(d);
+        gam.push_back(g);
+        ell.push_back(l);
+    }
+    fReader.close();
+
+    cout << "[** " << eps.size() << " sweep points read from file '" 
+         << _SWEEPNAME << "']" << endl;
+    if (eps.empty())
+        exit(111);
+    return eps.size();
+}
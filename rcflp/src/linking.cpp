@@ -0,0 +1,258 @@
+/***************************************************************************
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+/*! \file linking.cpp
+  \brief Handling of the linking rows \f$x_{ij} \leq y_i\f$ (flag -j).
+
+ * The linking rows only tighten the models: since demands are positive, the
+ * capacity rows already force \f$x_{ij} = 0\f$ when \f$y_i = 0\f$. Yet they
+ * are \f$n_F n_C\f$, i.e., most of the rows of every model. With **-j**:
+ * - **0** : they are added to the model (default);
+ * - **1** : they are separated by a user cut callback (see LinkingCallback),
+ *   at the root and in the tree, and added only when violated. With the
+ *   native builder, they are given to cplex as a user cut pool
+ *   (CPXaddusercuts()), which cplex checks in the same way;
+ * - **2** : they are dropped;
+ * - **3** : the three options are compared on the same model (see
+ *   compareLinking()), and a line is added to `linking/summary.csv`, so that
+ *   a run over a set of instances (e.g., OR Library or Avella) gives a
+ *   benchmark table (Concert builder only).
+ */
+
+#include <ilcplex/ilocplex.h>
+ILOSTLBEGIN
+
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <sstream>
+#include <cstdlib>
+#include <vector>
+#include <atomic>
+#include <chrono>
+
+using namespace std;
+
+
+struct INSTANCE { /// See same data structure define in rcflp.cpp
+    int nF;
+    int nC;
+    double  *f;
+    double  *s;
+    double  *d;
+    double **c;
+    double  *cT;   // costs in customer-major format (cT[j*nF+i])
+    double   totS;
+    double   totD;
+
+    int nR;        // number of constraints polyhedron uncertainty set
+    double  *h;    // rhs of polyhedron definining support
+    int     *W;    // matrix W in column major format
+    int *index;    // index of column major format for w
+    int *start;    // starting position for elements of column j
+};
+
+struct SOLUTION { /// See same data structure define in rcflp.cpp
+    int nOpen;
+    int  *ySol;
+    vector<int>    xBeg;  // customer-major sparse allocations (see rcflp.cpp)
+    vector<int>    xFac;
+    vector<double> xVal;
+    double zStar;
+    IloAlgorithm::Status zStatus;
+    IloNum startTime;
+    IloNum cpuTime;
+};
+
+typedef IloArray <IloNumVarArray> TwoD;
+extern TwoD x_ilo;
+extern IloNumVarArray y_ilo;
+extern IloModel model;
+extern IloEnv env;
+extern char * _FILENAME;
+extern string instanceType;
+extern int version;
+extern int support;
+extern int linkingMode;
+extern vector<char> candidate;
+extern vector<SOLUTION> starts;
+extern double INFTY;
+extern int solLimit;
+extern int timeLimit;
+extern int displayLimit;
+const double EPSI = 0.00001;
+
+int solveCplexProblem(IloModel model, IloCplex cplex, INSTANCE & inp, int solLimit, int timeLimit, int displayLimit);
+bool isCandidate(INSTANCE & inp, int i, int j);
+void linking_add_row(IloModel & model, int i, int j);
+void resetMIPStarts(IloCplex & cplex, INSTANCE & inp);
+
+IloRangeArray link_ilo;  //!< linking rows, kept to be removed from the model (-j 3)
+atomic<long> linkCuts(0); //!< Number of linking rows added by the callback (several threads)
+
+
+/// User cut callback: add the violated linking rows
+ILOUSERCUTCALLBACK1(LinkingCallback, INSTANCE *, pInp)
+{
+    INSTANCE & inp = *pInp;
+    IloEnv cbEnv = getEnv();
+    IloNumArray yVal(cbEnv);
+    IloNumArray xVal(cbEnv);
+    getValues(yVal, y_ilo);
+    for (int i = 0; i < inp.nF; i++)
+    {
+        if (yVal[i] > 1.0 - EPSI) // x_ij <= 1: no violation
+            continue;
+        if (candidate.empty())
+            getValues(xVal, x_ilo[i]);
+        for (int j = 0; j < inp.nC; j++)
+        {
+            if (!isCandidate(inp, i, j))
+                continue;
+            double xij = candidate.empty() ? xVal[j] : getValue(x_ilo[i][j]);
+            if (xij > yVal[i] + EPSI)
+            {
+                add(x_ilo[i][j] - y_ilo[i] <= 0.0, IloCplex::UseCutPurge).end();
+                linkCuts++;
+            }
+        }
+    }
+    xVal.end();
+    yVal.end();
+}
+
+/// Linking rows of the Concert models, according to -j (see the description of the file)
+void linking_rows(INSTANCE & inp, IloModel & model)
+{
+    if (linkingMode == 1 || linkingMode == 2)
+        return;
+    if (linkingMode == 3)
+        link_ilo = IloRangeArray(env);
+    for (int i = 0; i < inp.nF; i++)
+        for (int j = 0; j < inp.nC; j++)
+            if (isCandidate(inp, i, j))
+                linking_add_row(model, i, j);
+}
+
+/// Linking row of \f$x_{ij}\f$, if the rows are in the model (-j 0 or 3)
+void linking_add_row(IloModel & model, int i, int j)
+{
+    if (linkingMode == 1 || linkingMode == 2)
+        return;
+    IloRange row = (x_ilo[i][j] - y_ilo[i] <= 0.0);
+    model.add(row);
+    if (linkingMode == 3)
+        link_ilo.add(row);
+}
+
+/// Attach the separation callback, if needed (-j 1)
+void linking_use(IloCplex & cplex, INSTANCE & inp)
+{
+    if (linkingMode != 1)
+        return;
+    linkCuts = 0;
+    cplex.setParam(IloCplex::Param::Preprocessing::Linear, 0);
+    cplex.use(LinkingCallback(env, &inp));
+}
+
+/// Solve the same model with linking rows, separated linking rows and no linking rows (-j 3)
+void compareLinking(IloCplex & cplex, INSTANCE & inp)
+{
+    string method[3] = {"rows", "user cuts", "dropped"};
+    double wall[3], gap[3], zStar[3];
+    long   nodes[3], rows[3], cuts[3];
+    IloCplex::Callback cb;
+    for (int k = 0; k < 3; k++)
+    {
+        rows[k] = (k == 0) ? link_ilo.getSize() : 0;
+        linkCuts = 0;
+        if (k == 1)
+        {
+            model.remove(link_ilo);
+            cplex.setParam(IloCplex::Param::Preprocessing::Linear, 0);
+            cb = cplex.use(LinkingCallback(env, &inp));
+        }
+        else if (k == 2)
+        {
+            cplex.remove(cb);
+            cb.end();
+        }
+        cout << "[** Linking comparison :: solving with linking " << method[k] << "]" << endl;
+        if (k > 0) // not from the incumbent of the previous run
+            resetMIPStarts(cplex, inp);
+        cplex.setParam(IloCplex::AdvInd, starts.empty() ? 0 : 1);
+        auto start = chrono::system_clock::now();
+        gap[k]   = INFTY;
+        zStar[k] = INFTY;
+        if (solveCplexProblem(model, cplex, inp, solLimit, timeLimit, displayLimit) == 1)
+        {
+            zStar[k] = cplex.getObjValue();
+            gap[k]   = cplex.getMIPRelativeGap();
+        }
+        nodes[k] = cplex.getNnodes();
+        cuts[k]  = linkCuts;
+        wall[k]  = chrono::duration<double>(chrono::system_clock::now()-start).count();
+    }
+    // the solution kept is the last one (no linking rows): it is feasible for
+    // the model with them, as they only tighten the relaxation
+
+    string  s1      = string(_FILENAME);
+    s1              = s1.substr(s1.find_last_of("\\/"), 100);
+    ostringstream obj;
+    obj << "-v" << version << "-u" << support;
+    string filename = "linking" + s1 + obj.str() + ".txt";
+    ofstream fWriter(filename, ios::out);
+
+    cout << endl << "** LINKING ROWS: IN THE MODEL vs USER CUTS vs DROPPED **" << endl;
+    cout << setw(12) << "linking" << setw(12) << "rows" << setw(12) << "cuts"
+         << setw(12) << "time" << setw(12) << "nodes" << setw(12) << "gap"
+         << setw(20) << "z*" << endl;
+    fWriter << "linking;rows;cuts;time;nodes;gap;z" << endl;
+    for (int k = 0; k < 3; k++)
+    {
+        cout << setw(12) << method[k] << setw(12) << rows[k] << setw(12) << cuts[k]
+             << setw(12) << setprecision(4) << wall[k] << setw(12) << nodes[k]
+             << setw(12) << gap[k] << setw(20) << setprecision(12) << zStar[k] << endl;
+        fWriter << method[k] << ";" << rows[k] << ";" << cuts[k] << ";" << wall[k] << ";"
+                << nodes[k] << ";" << gap[k] << ";" << setprecision(15) << zStar[k]
+                << setprecision(6) << endl;
+    }
+    int best = 0;
+    for (int k = 1; k < 3; k++)
+        if (wall[k] < wall[best])
+            best = k;
+    cout << "[** Fastest :: linking " << method[best] << "]" << endl;
+    fWriter.close();
+    cout << "Linking report written to disk. ('" << filename << "')" << endl;
+
+    // one line per instance: a run over a set gives the benchmark table
+    string summary = "linking/summary.csv";
+    ifstream fCheck(summary);
+    bool header = !fCheck.good();
+    fCheck.close();
+    ofstream fSummary(summary, ios::app);
+    if (header)
+        fSummary << "instance;type;nF;nC;version;support;time rows;time cuts;time dropped;"
+                 << "nodes rows;nodes cuts;nodes dropped;cuts;z rows;z cuts;z dropped" << endl;
+    fSummary << s1.substr(1) << ";" << instanceType << ";" << inp.nF << ";" << inp.nC
+             << ";" << version << ";" << support << ";" << wall[0] << ";" << wall[1] << ";"
+             << wall[2] << ";" << nodes[0] << ";" << nodes[1] << ";" << nodes[2] << ";"
+             << cuts[1] << ";" << setprecision(15) << zStar[0] << ";" << zStar[1] << ";"
+             << zStar[2] << setprecision(6) << endl;
+    fSummary.close();
+    cout << "Linking summary updated. ('" << summary << "')" << endl << endl;
+}
@@ -0,0 +1,301 @@
+/***************************************************************************
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+/*! \file modelsize.cpp
+  \brief Size and memory estimate of the model, before it is built (flags -D and -M).
+
+ * Right before the model is built (i.e., after reading the instance, the
+ * preprocessing and the candidate lists), model_check() computes the number
+ * of variables, and of rows and nonzeros of each family of constraints, of
+ * the model selected by the options. The support is not generated: its size
+ * only depends on its parameters (see read_parameters_box() and
+ * read_parameters_budget()), i.e., \f$r = 2n_C\f$ rows and \f$2n_C\f$
+ * nonzeros in \f$W\f$ for the box, plus \f$L\f$ rows with
+ * \f$\lfloor \gamma n_C \rfloor\f$ nonzeros each for the budget. The counts
+ * are thus exact, with two exceptions: whether the compact model is built
+ * for a budget support (-c) is predicted from \f$\delta \geq 1 + \epsilon\f$
+ * (the sets \f$B_l\f$ are drawn with the model), and the rows added by row
+ * generation (-R) during the solve are not counted.
+ *
+ * The memory estimate adds up the instance data, the Concert objects (with
+ * the Concert builder), the problem stored by cplex and a presolved copy of
+ * it, with the costs per variable, row and nonzero given below. It is a
+ * rough figure, to be compared with the peak memory reported after the build
+ * (see printBuildInfo()) or by the trace of the phases (flag -E).
+ *
+ * After the preprocessing (-F), model_reduction() prints the same figures
+ * for the full and the reduced instance.
+ *
+ * - **-D 1** : dry run: print the table and stop before the build.
+ * - **-M** `MB` : memory budget. If the estimate exceeds it, the model is
+ *   not built with these options. For the dualized polyhedral model we
+ *   switch to row generation (-R 1), and otherwise to the native builder
+ *   (-b 1), if the new estimate fits in the budget; else the run stops.
+ */
+
+#include <ilcplex/ilocplex.h>
+ILOSTLBEGIN
+
+#include <iostream>
+#include <iomanip>
+#include <cstdlib>
+#include <cmath>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+using namespace std;
+
+
+struct INSTANCE { /// See same data structure define in rcflp.cpp
+    int nF;
+    int nC;
+    double  *f;
+    double  *s;
+    double  *d;
+    double **c;
+    double  *cT;   // costs in customer-major format (cT[j*nF+i])
+    double   totS;
+    double   totD;
+
+    int nR;        // number of constraints polyhedron uncertainty set
+    double  *h;    // rhs of polyhedron definining support
+    int     *W;    // matrix W in column major format
+    int *index;    // index of column major format for w
+    int *start;    // starting position for elements of column j
+};
+
+extern double _epsilon;
+extern double _delta;
+extern double _gamma;
+extern int    L;
+extern double _epsilon_input;
+extern double _delta_input;
+extern double _gamma_input;
+extern int    L_input;
+extern int version;
+extern int support;
+extern int builder;
+extern int compactBox;
+extern int rowGeneration;
+extern int bendersMode;
+extern int candidateK;
+extern int linkingMode;
+extern int dryRun;
+extern int memoryBudget;
+extern double modelEstimate;
+extern vector<char> candidate;
+
+void read_parameters_box();
+void read_parameters_budget();
+
+// memory per object (bytes): rough guesses, not measured, to be checked
+// against the peak memory of actual builds (see printBuildInfo()). Concert
+// variable and row (with name), term of a linear expression; cplex column,
+// row and nonzero (stored by rows and by columns)
+const double CONCERT_VAR = 140.0;
+const double CONCERT_ROW = 160.0;
+const double CONCERT_NZ  = 32.0;
+const double CPLEX_VAR   = 60.0;
+const double CPLEX_ROW   = 50.0;
+const double CPLEX_NZ    = 24.0;
+const double PRESOLVE    = 2.0;   //!< the presolved problem is a second copy
+const double MB          = 1024.0*1024.0;
+
+/// A family of constraints
+struct FAMILY {
+    string name;
+    long   rows;
+    long   nz;
+};
+
+/// Size of a model (see model_size())
+struct MODEL_SIZE {
+    string         name;   //!< Model
+    long           vars;   //!< Number of variables
+    long           ints;   //!< Number of integer variables
+    vector<FAMILY> rows;   //!< Families of constraints
+    long           nzObj;  //!< Nonzeros in the objective
+    double         data;   //!< Instance data (MB)
+
+    long nRows() const { long n = 0; for (const FAMILY & f : rows) n += f.rows; return n; }
+    long nNz() const { long n = nzObj; for (const FAMILY & f : rows) n += f.nz; return n; }
+
+    /// Estimated memory (MB) with the given builder (0-Concert; 1-Native)
+    double memory(int build) const
+    {
+        long largest = 0; // the native builder keeps one family at a time
+        for (const FAMILY & f : rows)
+            largest = max(largest, f.nz);
+        double cplex = PRESOLVE*(vars*CPLEX_VAR + nRows()*CPLEX_ROW + nNz()*CPLEX_NZ);
+        if (build == 1)
+            return data + (cplex + largest*12.0)/MB;
+        return data + (cplex + vars*CONCERT_VAR + nRows()*CONCERT_ROW + nNz()*CONCERT_NZ)/MB;
+    }
+};
+
+
+/// Size of the model of version v built on inp, with or without row generation
+MODEL_SIZE model_size(INSTANCE & inp, int v, bool rowgen)
+{
+    long nF = inp.nF, nC = inp.nC;
+    long nX = nF*nC; // allocation variables (candidate ones only, see candidates.cpp)
+    if (!candidate.empty() && (v == 2 || v == 4))
+        nX = count(candidate.begin(), candidate.end(), 1);
+
+    MODEL_SIZE m;
+    m.data  = 8.0*nF*nC/MB + (candidate.empty() ? 0.0 : 1.0*nF*nC/MB);
+    m.vars  = nF + nX;
+    m.ints  = (v == 1) ? nF + nX : nF;
+    m.nzObj = nF + nX;
+    long link = (linkingMode == 0 || linkingMode == 3) ? nX : 0;
+
+    // support: r rows of W with nnzW nonzeros (see the description of the file)
+    long nR = 0, nnzW = 0;
+    bool compact = false;
+    if (v == 4)
+    {
+        if (support == 1)
+            read_parameters_box();
+        else
+            read_parameters_budget();
+        if (_epsilon_input != -1) _epsilon = _epsilon_input;
+        if (_delta_input != -1) _delta = _delta_input;
+        if (_gamma_input != -1) _gamma = _gamma_input;
+        if (L_input != -1) L = L_input;
+        long nBl = (support == 2) ? (long) floor(_gamma*(double)nC) : 0;
+        long nL  = (support == 2) ? L : 0;
+        nR       = 2*nC + nL;
+        nnzW     = 2*nC + nL*nBl;
+        compact  = compactBox > 0 && !rowgen
+                   && (support == 1 || nL == 0 || nBl == 0 || _delta >= 1.0 + _epsilon);
+    }
+
+    if (v == 1 || v == 2 || compact)
+    {
+        m.name = (v == 1) ? "single-source" : (v == 2) ? "multi-source" : "compact (box)";
+        m.rows.push_back({"demand", nC, nX});
+        m.rows.push_back({"capacity", nF, nX + nF});
+    }
+    else if (v == 3)
+    {
+        m.name  = "ellipsoidal";
+        m.vars += nC + 1; // q and w
+        m.nzObj++;
+        m.rows.push_back({"demand", nC, nX});
+        m.rows.push_back({"cone_w (quadratic)", 1, nX + 1});
+        m.rows.push_back({"cone_q (quadratic)", nF, nX + nF});
+        m.rows.push_back({"capacity", nF, nX + 2*nF});
+    }
+    else if (rowgen)
+    {
+        m.name  = "row generation master";
+        m.vars += 1; // eta
+        m.nzObj = nF + 1;
+        m.rows.push_back({"demand", nC, nX});
+        m.rows.push_back({"capacity", nF, nX + nF});
+        m.rows.push_back({"cost", 1, nX + 1});
+    }
+    else
+    {
+        m.name  = "dualized polyhedral";
+        m.vars += nF*nR + nR + 1; // psi, u and delta
+        m.nzObj = nF + 1;
+        m.data += 8.0*nF*nC/MB;    // customer-major costs (see define_customer_major())
+        m.rows.push_back({"demand", nC, nX});
+        m.rows.push_back({"rob_cap", nF, nF*nR + nF});
+        m.rows.push_back({"rob_dem_constr", nF*nC, nF*nnzW + nX});
+        m.rows.push_back({"rob_delta", 1, nR + 1});
+        m.rows.push_back({"rob_obj", nC, nnzW + nX});
+    }
+    m.rows.push_back({"linking", link, 2*link});
+    return m;
+}
+
+/// Print the size of a model and its memory estimate
+void model_print(MODEL_SIZE & m, int build)
+{
+    cout << endl << "** MODEL SIZE: " << m.name << " (" << (build == 1 ? "native" : "Concert")
+         << " builder) **" << endl;
+    cout << setw(22) << "family" << setw(16) << "rows" << setw(16) << "nonzeros" << endl;
+    for (FAMILY & f : m.rows)
+        cout << setw(22) << f.name << setw(16) << f.rows << setw(16) << f.nz << endl;
+    cout << setw(22) << "objective" << setw(16) << "" << setw(16) << m.nzObj << endl;
+    cout << setw(22) << "total" << setw(16) << m.nRows() << setw(16) << m.nNz() << endl;
+    cout << "[** " << m.vars << " variables (" << m.ints << " integer); estimated memory "
+         << setprecision(6) << m.memory(build) << " MB (instance data " << m.data << " MB)]"
+         << endl << endl;
+}
+
+/// Size of the model before and after the preprocessing (flag -F, see preprocess.cpp)
+void model_reduction(INSTANCE & full, INSTANCE & red)
+{
+    bool rowgen = (version == 4 && rowGeneration > 0);
+    MODEL_SIZE m = model_size(full, version, rowgen);
+    MODEL_SIZE r = model_size(red, version, rowgen);
+    cout << "[** Preprocessing :: " << m.name << " model from " << m.vars << " to " << r.vars
+         << " variables, " << m.nRows() << " to " << r.nRows() << " rows, " << m.nNz()
+         << " to " << r.nNz() << " nonzeros; estimated memory " << setprecision(6)
+         << m.memory(builder) << " to " << r.memory(builder) << " MB]" << endl;
+}
+
+/// Size of the model, dry run (-D) and memory budget (-M), before the build
+/**
+ * Returns 1 if the model can be built (possibly after switching to row
+ * generation or to the native builder), 0 after a dry run, and -1 if the
+ * estimate exceeds the memory budget.
+ */
+int model_check(INSTANCE & inp)
+{
+    MODEL_SIZE m = model_size(inp, version, version == 4 && rowGeneration > 0);
+    model_print(m, builder);
+    modelEstimate = m.memory(builder);
+    if (dryRun > 0)
+    {
+        cout << "[** Dry run (-D): the model is not built]" << endl;
+        return 0;
+    }
+    if (memoryBudget <= 0 || modelEstimate <= memoryBudget)
+        return 1;
+
+    cout << "[** Estimated memory " << modelEstimate << " MB exceeds the budget of "
+         << memoryBudget << " MB (-M)]" << endl;
+    bool dualized = (version == 4 && rowGeneration == 0 && m.name == "dualized polyhedral");
+    if (dualized && builder == 0 && candidateK == 0 && bendersMode == 0 && linkingMode != 3)
+    {
+        MODEL_SIZE rg = model_size(inp, version, true);
+        if (rg.memory(0) <= memoryBudget)
+        {
+            cout << "[** Switching to row generation (-R 1): estimated memory "
+                 << rg.memory(0) << " MB]" << endl;
+            rowGeneration = 1;
+            modelEstimate = rg.memory(0);
+            return 1;
+        }
+    }
+    if (builder == 0 && rowGeneration == 0 && candidateK == 0 && bendersMode == 0
+        && linkingMode != 3 && m.memory(1) <= memoryBudget)
+    {
+        cout << "[** Switching to the native builder (-b 1): estimated memory "
+             << m.memory(1) << " MB]" << endl;
+        builder       = 1;
+        modelEstimate = m.memory(1);
+        return 1;
+    }
+    cout << "[** No formulation fits in the memory budget: the model is not built]" << endl;
+    return -1;
+}
@@ -0,0 +1,677 @@
+/***************************************************************************
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+/*! \file native.cpp 
+  \brief Matrix-based model builder (CPLEX callable library).
+
+ * This is an alternative to the Concert models defined in rcflp.cpp
+ * (define_SS_CFLP(), define_MS_CFLP(), define_SOCP_CFLP() and
+ * define_POLY_CFLP()). It is activated with the command line flag **-b 1**.
+ *
+ * The Concert models build each row through an `IloExpr` and add one
+ * constraint at a time. Here, instead, the model is written directly in
+ * matrix format:
+ * * columns (objective, bounds and type) are created with a single call to
+ *   `CPXnewcols`;
+ * * rows are assembled in compressed sparse row (CSR) format, one family of
+ *   constraints at a time (demand, capacity, robust rows, linking rows, ...),
+ *   and each family is loaded with a single call to `CPXaddrows`. Only one
+ *   family is kept in memory at a time;
+ * * the quadratic constraints of the ellipsoidal model are added with
+ *   `CPXaddqconstr`.
+ *
+ * Columns are numbered as follows (\f$m\f$ facilities, \f$n\f$ customers,
+ * \f$r\f$ rows of \f$W\f$):
+ * * \f$y_i\f$ : column \f$i\f$
+ * * \f$x_{ij}\f$ : column \f$m + in + j\f$
+ * * ellipsoidal model: \f$q_i\f$ and then \f$w\f$
+ * * polyhedral model: \f$\psi_{it}\f$ (column \f$m + mn + ir + t\f$),
+ *   \f$u_t\f$ and then \f$\delta\f$
+ *
+ * The models are exactly the ones of the Concert version, so that the two
+ * builders can be compared in terms of building time and peak memory.
+ */
+
+#include <ilcplex/ilocplex.h>
+#include <ilcplex/cplex.h>
+ILOSTLBEGIN
+
+#include <iostream>
+#include <iomanip>
+#include <cstdlib>
+#include <vector>
+
+#include "phases.h"
+
+using namespace std;
+
+
+struct INSTANCE { /// See same data structure define in rcflp.cpp
+    int nF;
+    int nC;
+    double  *f;
+    double  *s;
+    double  *d;
+    double **c;
+    double  *cT;   // costs in customer-major format (cT[j*nF+i])
+    double   totS;
+    double   totD;
+
+    int nR;        // number of constraints polyhedron uncertainty set
+    double  *h;    // rhs of polyhedron definining support
+    int     *W;    // matrix W in column major format
+    int *index;    // index of column major format for w
+    int *start;    // starting position for elements of column j
+};
+
+struct SOLUTION { /// See same data structure define in rcflp.cpp
+    int nOpen;
+    int  *ySol;
+    vector<int>    xBeg;  // customer-major sparse allocations (see rcflp.cpp)
+    vector<int>    xFac;
+    vector<double> xVal;
+    double zStar;
+    IloAlgorithm::Status zStatus;
+    IloNum startTime;
+    IloNum cpuTime;
+};
+
+/// A family of rows in compressed sparse row format
+struct CSR {
+    vector<int>    beg;    //!< starting position of each row
+    vector<int>    ind;    //!< column indices
+    vector<double> val;    //!< coefficients
+    vector<double> rhs;    //!< right hand sides
+    vector<char>   sense;  //!< 'L', 'E' or 'G'
+
+    void newRow(char sns, double b) 
+    {
+        beg.push_back(ind.size());
+        sense.push_back(sns);
+        rhs.push_back(b);
+    }
+    void add(int col, double coef)
+    {
+        ind.push_back(col);
+        val.push_back(coef);
+    }
+    void clear()
+    {
+        vector<int>().swap(beg);
+        vector<int>().swap(ind);
+        vector<double>().swap(val);
+        vector<double>().swap(rhs);
+        vector<char>().swap(sense);
+    }
+};
+
+extern double _Omega;
+extern double _epsilon;
+extern double _delta;
+extern double _gamma;
+extern int    L;      
+extern double _Omega_input;
+extern double _epsilon_input;
+extern double _delta_input;
+extern double _gamma_input;
+extern int    L_input;
+const double EPSI = 0.00001;
+
+extern int    nThreads;
+extern int    compactBox;
+extern bool   compactBuilt;
+extern int    linkingMode;
+extern int    parallelMode;
+
+extern double INFTY;
+
+void read_parameters_ellipsoidal();
+void define_box_support(INSTANCE & inp);
+void define_budget_support(INSTANCE & inp, bool fromDisk);
+void define_customer_major(INSTANCE & inp);
+bool box_worst_case(INSTANCE & inp, vector<double> & dMax);
+void solution_set_x(INSTANCE & inp, SOLUTION & sol, vector<int> & fac, vector<int> & cus,
+                    vector<double> & val);
+void exportModel(IloCplex * cplex);
+bool trajectory_start();
+void trajectory_sample(double incumbent, double bound, long nodes, long open);
+void trajectory_stop(double incumbent, double bound, long nodes, long open);
+
+CPXENVptr cpxEnv = NULL; //!< Callable library environment
+CPXLPptr  cpxLp  = NULL; //!< Callable library problem
+int nativeStarts = 0;    //!< Number of MIP starts added to the problem
+
+
+/// Stop if a callable library routine returned an error.
+void native_check(int status, const char * routine)
+{
+    if (status == 0)
+        return;
+    char buffer[CPXMSGBUFSIZE];
+    if (CPXgeterrorstring(cpxEnv, status, buffer) == NULL)
+        sprintf(buffer, "error %d", status);
+    cout << "ERROR in " << routine << " : " << buffer << endl;
+    exit(124);
+}
+
+/// Load a family of rows in the problem (one call to CPXaddrows).
+void native_load_rows(CSR & rows)
+{
+    int nRows = rows.rhs.size();
+    if (nRows == 0)
+        return;
+    native_check(CPXaddrows(cpxEnv, cpxLp, 0, nRows, rows.ind.size(), 
+                            rows.rhs.data(), rows.sense.data(), rows.beg.data(), 
+                            rows.ind.data(), rows.val.data(), NULL, NULL), 
+                 "CPXaddrows");
+    rows.clear();
+}
+
+/// Create the columns \f$y\f$ and \f$x\f$ (common to all the versions).
+/**
+ * `xType` is `CPX_BINARY` for the single-source model and `CPX_CONTINUOUS`
+ * otherwise. `xCost` tells whether the transportation cost goes into the
+ * objective function (nominal and ellipsoidal models) or not (polyhedral
+ * model, where it is bounded by \f$\delta\f$).
+ */
+void native_location_allocation_cols(INSTANCE & inp, char xType, bool xCost,
+                                     vector<double> & obj, vector<double> & lb,
+                                     vector<double> & ub, vector<char> & ctype)
+{
+    for (int i = 0; i < inp.nF; i++)
+    {
+        obj.push_back(inp.f[i]);
+        lb.push_back(0.0);
+        ub.push_back(1.0);
+        ctype.push_back(CPX_BINARY);
+    }
+    for (int i = 0; i < inp.nF; i++)
+        for (int j = 0; j < inp.nC; j++)
+        {
+            obj.push_back(xCost ? inp.d[j]*inp.c[i][j] : 0.0);
+            lb.push_back(0.0);
+            ub.push_back(1.0);
+            ctype.push_back(xType);
+        }
+}
+
+/// Demand rows: \f$\sum_i x_{ij} = 1\f$.
+void native_demand_rows(INSTANCE & inp, CSR & rows)
+{
+    for (int j = 0; j < inp.nC; j++)
+    {
+        rows.newRow('E', 1.0);
+        for (int i = 0; i < inp.nF; i++)
+            rows.add(inp.nF + i*inp.nC + j, 1.0);
+    }
+    native_load_rows(rows);
+}
+
+/// Capacity rows: \f$\sum_j d_jx_{ij} + \Omega q_i - s_iy_i \leq 0\f$.
+/** The \f$q_i\f$ term is only used by the ellipsoidal model (`qCol >= 0`). */
+void native_capacity_rows(INSTANCE & inp, CSR & rows, int qCol)
+{
+    for (int i = 0; i < inp.nF; i++)
+    {
+        rows.newRow('L', 0.0);
+        for (int j = 0; j < inp.nC; j++)
+            rows.add(inp.nF + i*inp.nC + j, inp.d[j]);
+        if (qCol >= 0)
+            rows.add(qCol + i, _Omega);
+        rows.add(i, -inp.s[i]);
+    }
+    native_load_rows(rows);
+}
+
+/// Linking rows: \f$x_{ij} - y_i \leq 0\f$.
+/**
+ * With -j 1 they go to the user cut pool, and cplex adds them only when
+ * violated; with -j 2 they are dropped (see linking.cpp).
+ */
+void native_linking_rows(INSTANCE & inp, CSR & rows)
+{
+    if (linkingMode == 2)
+        return;
+    rows.beg.reserve((long)inp.nF*inp.nC);
+    rows.ind.reserve(2*(long)inp.nF*inp.nC);
+    rows.val.reserve(2*(long)inp.nF*inp.nC);
+    for (int i = 0; i < inp.nF; i++)
+        for (int j = 0; j < inp.nC; j++)
+        {
+            rows.newRow('L', 0.0);
+            rows.add(inp.nF + i*inp.nC + j, 1.0);
+            rows.add(i, -1.0);
+        }
+    if (linkingMode == 1)
+    {
+        native_check(CPXaddusercuts(cpxEnv, cpxLp, rows.rhs.size(), rows.ind.size(),
+                                    rows.rhs.data(), rows.sense.data(), rows.beg.data(),
+                                    rows.ind.data(), rows.val.data(), NULL),
+                     "CPXaddusercuts");
+        native_check(CPXsetintparam(cpxEnv, CPXPARAM_Preprocessing_Linear, 0),
+                     "CPXsetintparam");
+        rows.clear();
+    }
+    else
+        native_load_rows(rows);
+}
+
+/// Nominal single-source (`singleSource = true`) and multi-source models.
+/** Same model as define_SS_CFLP() and define_MS_CFLP(). */
+void native_NOMINAL_CFLP(INSTANCE & inp, bool singleSource)
+{
+    vector<double> obj, lb, ub;
+    vector<char>   ctype;
+    native_location_allocation_cols(inp, singleSource ? CPX_BINARY : CPX_CONTINUOUS, 
+                                    true, obj, lb, ub, ctype);
+    native_check(CPXnewcols(cpxEnv, cpxLp, obj.size(), obj.data(), lb.data(), 
+                            ub.data(), ctype.data(), NULL), "CPXnewcols");
+
+    CSR rows;
+    native_demand_rows(inp, rows);
+    native_capacity_rows(inp, rows, -1);
+    native_linking_rows(inp, rows);
+}
+
+/// Ellipsoidal model. Same model as define_SOCP_CFLP().
+void native_SOCP_CFLP(INSTANCE & inp)
+{
+    read_parameters_ellipsoidal();
+
+if (_Omega_input!=-1) _Omega = _Omega_input;
+if (_epsilon_input!=-1) _epsilon = _epsilon_input;
+if (_delta_input!=-1) _delta = _delta_input;
+if (_gamma_input!=-1) _gamma = _gamma_input;
+if (L_input!=-1) L = L_input;
+
+    vector<double> obj, lb, ub;
+    vector<char>   ctype;
+    native_location_allocation_cols(inp, CPX_CONTINUOUS, true, obj, lb, ub, ctype);
+    int qCol = obj.size();
+    for (int i = 0; i < inp.nF; i++)
+    {
+        obj.push_back(0.0);
+        lb.push_back(0.0);
+        ub.push_back(CPX_INFBOUND);
+        ctype.push_back(CPX_CONTINUOUS);
+    }
+    int wCol = obj.size();
+    obj.push_back(_Omega);
+    lb.push_back(0.0);
+    ub.push_back(CPX_INFBOUND);
+    ctype.push_back(CPX_CONTINUOUS);
+    native_check(CPXnewcols(cpxEnv, cpxLp, obj.size(), obj.data(), lb.data(), 
+                            ub.data(), ctype.data(), NULL), "CPXnewcols");
+
+    CSR rows;
+    native_demand_rows(inp, rows);
+    native_capacity_rows(inp, rows, qCol);
+    native_linking_rows(inp, rows);
+
+    // second order cone W: sum (eps c_ij x_ij)^2 - w^2 <= 0
+    vector<int>    qrow, qcol;
+    vector<double> qval;
+    for (int i = 0; i < inp.nF; i++)
+        for (int j = 0; j < inp.nC; j++)
+        {
+            int col = inp.nF + i*inp.nC + j;
+            qrow.push_back(col);
+            qcol.push_back(col);
+            qval.push_back(inp.c[i][j]*_epsilon*inp.c[i][j]*_epsilon);
+        }
+    qrow.push_back(wCol);
+    qcol.push_back(wCol);
+    qval.push_back(-1.0);
+    native_check(CPXaddqconstr(cpxEnv, cpxLp, 0, qval.size(), 0.0, 'L', NULL, NULL,
+                               qrow.data(), qcol.data(), qval.data(), NULL), 
+                 "CPXaddqconstr");
+
+    // Q conic constraints: sum (eps x_ij)^2 - q_i^2 <= 0
+    for (int i = 0; i < inp.nF; i++)
+    {
+        qrow.clear();
+        qcol.clear();
+        qval.clear();
+        for (int j = 0; j < inp.nC; j++)
+        {
+            int col = inp.nF + i*inp.nC + j;
+            qrow.push_back(col);
+            qcol.push_back(col);
+            qval.push_back(_epsilon*_epsilon);
+        }
+        qrow.push_back(qCol + i);
+        qcol.push_back(qCol + i);
+        qval.push_back(-1.0);
+        native_check(CPXaddqconstr(cpxEnv, cpxLp, 0, qval.size(), 0.0, 'L', NULL, NULL,
+                                   qrow.data(), qcol.data(), qval.data(), NULL), 
+                     "CPXaddqconstr");
+    }
+}
+
+/// Polyhedral model. Same model as define_POLY_CFLP().
+void native_POLY_CFLP(INSTANCE & inp, int support)
+{
+    switch (support)
+    {
+        case 1 :
+            define_box_support(inp);
+            break;
+        case 2 : 
+            define_budget_support(inp, false);
+            break;
+        default :
+            cout << "ERROR : Support type not defined.\n" << endl;
+            exit(123);
+    }
+
+    // analytic worst case: nominal model with demand dMax (see define_POLY_CFLP())
+    vector<double> dMax;
+    compactBuilt = (compactBox > 0 && box_worst_case(inp, dMax));
+    if (compactBuilt)
+    {
+        cout << "[** Analytic worst case: compact model (" << inp.nR 
+             << " support rows dropped)]" << endl;
+        double * dNom = inp.d;
+        inp.d = dMax.data();
+        native_NOMINAL_CFLP(inp, false);
+        inp.d = dNom;
+        return;
+    }
+
+    vector<double> obj, lb, ub;
+    vector<char>   ctype;
+    native_location_allocation_cols(inp, CPX_CONTINUOUS, false, obj, lb, ub, ctype);
+    int psiCol   = obj.size();
+    int uCol     = psiCol + inp.nF*inp.nR;
+    int deltaCol = uCol + inp.nR;
+    int nCols    = deltaCol + 1;
+    obj.resize(nCols, 0.0);
+    lb.resize(nCols, 0.0);
+    ub.resize(nCols, CPX_INFBOUND);
+    ctype.resize(nCols, CPX_CONTINUOUS);
+    obj[deltaCol] = 1.0;
+    native_check(CPXnewcols(cpxEnv, cpxLp, nCols, obj.data(), lb.data(), 
+                            ub.data(), ctype.data(), NULL), "CPXnewcols");
+    vector<double>().swap(obj);
+    vector<double>().swap(lb);
+    vector<double>().swap(ub);
+    vector<char>().swap(ctype);
+
+    CSR rows;
+    native_demand_rows(inp, rows);
+
+    // robust capacity h*psi <= s*y
+    for (int i = 0; i < inp.nF; i++)
+    {
+        rows.newRow('L', 0.0);
+        for (int t = 0; t < inp.nR; t++)
+            rows.add(psiCol + i*inp.nR + t, inp.h[t]);
+        rows.add(i, -inp.s[i]);
+    }
+    native_load_rows(rows);
+
+    // "robust" demand - constr. W*psi >= x (loaded one facility at a time)
+    for (int i = 0; i < inp.nF; i++)
+    {
+        for (int j = 0; j < inp.nC; j++)
+        {
+            rows.newRow('G', 0.0);
+            for (int l = inp.start[j]; l < inp.start[j+1]; l++)
+                rows.add(psiCol + i*inp.nR + inp.index[l], inp.W[l]);
+            rows.add(inp.nF + i*inp.nC + j, -1.0);
+        }
+        native_load_rows(rows);
+    }
+
+    // "robust" objective function: h*u <= delta
+    rows.newRow('L', 0.0);
+    for (int t = 0; t < inp.nR; t++)
+        rows.add(uCol + t, inp.h[t]);
+    rows.add(deltaCol, -1.0);
+    native_load_rows(rows);
+
+    // second robust obj function: W*u >= c*x
+    define_customer_major(inp);
+    for (int j = 0; j < inp.nC; j++)
+    {
+        rows.newRow('G', 0.0);
+        for (int l = inp.start[j]; l < inp.start[j+1]; l++)
+            rows.add(uCol + inp.index[l], inp.W[l]);
+        const double * cj = inp.cT + (long)j*inp.nF;
+        for (int i = 0; i < inp.nF; i++)
+            rows.add(inp.nF + i*inp.nC + j, -cj[i]);
+    }
+    native_load_rows(rows);
+
+    native_linking_rows(inp, rows);
+}
+
+/// Build the model of the given version with the callable library.
+void native_define_CFLP(INSTANCE & inp, int version, int support)
+{
+    int status = 0;
+    cpxEnv = CPXopenCPLEX(&status);
+    if (cpxEnv == NULL)
+        native_check(status, "CPXopenCPLEX");
+    cpxLp = CPXcreateprob(cpxEnv, &status, "cflp");
+    if (cpxLp == NULL)
+        native_check(status, "CPXcreateprob");
+    native_check(CPXchgobjsen(cpxEnv, cpxLp, CPX_MIN), "CPXchgobjsen");
+
+    switch(version)
+    {
+        case 1 :  // single source nominal
+            native_NOMINAL_CFLP(inp, true);
+            break;
+        case 2 : // multi source nominal
+            native_NOMINAL_CFLP(inp, false);
+            break;
+        case 3 : // multi source ellipsoidal
+            native_SOCP_CFLP(inp);
+            break;
+        case 4 : // robust polyhedral uncertainty set (both SS and MS)
+            native_POLY_CFLP(inp, support);
+            break;
+        default :
+            cout << "ERROR : Version type not defined.\n" << endl;
+            exit(123);
+    }
+
+    cout << "[** Native model :: " << CPXgetnumcols(cpxEnv, cpxLp) << " columns, "
+         << CPXgetnumrows(cpxEnv, cpxLp) << " rows, " 
+         << CPXgetnumnz(cpxEnv, cpxLp) << " nonzeros]" << endl;
+}
+
+/// Add a solution as MIP start (see addMIPStarts()).
+/** Columns \f$y_i\f$ and \f$x_{ij}\f$ come first in every native model. */
+void native_add_start(INSTANCE & inp, SOLUTION & sol)
+{
+    vector<int>    ind;
+    vector<double> val;
+    for (int i = 0; i < inp.nF; i++)
+    {
+        ind.push_back(i);
+        val.push_back(sol.ySol[i]);
+    }
+    for (int j = 0; j < inp.nC; j++) // nonzero allocations only (completed by cplex)
+        for (int k = sol.xBeg[j]; k < sol.xBeg[j+1]; k++)
+        {
+            ind.push_back(inp.nF + sol.xFac[k]*inp.nC + j);
+            val.push_back(sol.xVal[k]);
+        }
+
+    int beg    = 0;
+    int effort = CPX_MIPSTART_REPAIR;
+    native_check(CPXaddmipstarts(cpxEnv, cpxLp, 1, ind.size(), &beg, ind.data(), 
+                                 val.data(), &effort, NULL), "CPXaddmipstarts");
+    nativeStarts++;
+}
+
+/// Informational callback of the native model: progress trajectory (see trajectory.cpp)
+int CPXPUBLIC native_trajectory_callback(CPXCENVptr env, void * cbdata, int wherefrom,
+                                         void * /* cbhandle */)
+{
+    int     feasible = 0;
+    double  incumbent, bound;
+    CPXLONG nodes, open;
+    CPXgetcallbackinfo(env, cbdata, wherefrom, CPX_CALLBACK_INFO_MIP_FEAS, &feasible);
+    CPXgetcallbackinfo(env, cbdata, wherefrom, CPX_CALLBACK_INFO_BEST_INTEGER, &incumbent);
+    CPXgetcallbackinfo(env, cbdata, wherefrom, CPX_CALLBACK_INFO_BEST_REMAINING, &bound);
+    CPXgetcallbackinfo(env, cbdata, wherefrom, CPX_CALLBACK_INFO_NODE_COUNT_LONG, &nodes);
+    CPXgetcallbackinfo(env, cbdata, wherefrom, CPX_CALLBACK_INFO_NODES_LEFT_LONG, &open);
+    trajectory_sample(feasible ? incumbent : INFTY, bound, nodes, open);
+    return 0;
+}
+
+/// Set cplex parameters and solve the native model (see solveCplexProblem()).
+int native_solve(int solLimit, int timeLimit, int displayLimit)
+{
+    native_check(CPXsetintparam(cpxEnv, CPXPARAM_ScreenOutput, CPX_ON), "CPXsetintparam");
+    native_check(CPXsetintparam(cpxEnv, CPXPARAM_Threads, nThreads), "CPXsetintparam");
+    native_check(CPXsetintparam(cpxEnv, CPXPARAM_Parallel, parallelMode), "CPXsetintparam");
+    native_check(CPXsetintparam(cpxEnv, CPXPARAM_Advance, nativeStarts > 0 ? 1 : 0), 
+                 "CPXsetintparam");
+    native_check(CPXsetintparam(cpxEnv, CPXPARAM_ClockType, 2), "CPXsetintparam");
+    native_check(CPXsetintparam(cpxEnv, CPXPARAM_MIP_Interval, 5000), "CPXsetintparam");
+    native_check(CPXsetintparam(cpxEnv, CPXPARAM_MIP_Display, displayLimit), "CPXsetintparam");
+    native_check(CPXsetintparam(cpxEnv, CPXPARAM_MIP_Limits_Solutions, solLimit), "CPXsetintparam");
+    native_check(CPXsetdblparam(cpxEnv, CPXPARAM_TimeLimit, timeLimit), "CPXsetdblparam");
+
+    exportModel(NULL);
+
+    bool trajectory = trajectory_start();
+    if (trajectory)
+        native_check(CPXsetinfocallbackfunc(cpxEnv, native_trajectory_callback, NULL),
+                     "CPXsetinfocallbackfunc");
+    int status;
+    {
+        PHASE_TIMER phase("solve");
+        status = CPXmipopt(cpxEnv, cpxLp);
+    }
+    if (trajectory)
+    {
+        double incumbent, bound;
+        if (CPXgetobjval(cpxEnv, cpxLp, &incumbent) != 0)
+            incumbent = INFTY;
+        if (CPXgetbestobjval(cpxEnv, cpxLp, &bound) != 0)
+            bound = -INFTY;
+        trajectory_stop(incumbent, bound, CPXgetnodecnt(cpxEnv, cpxLp),
+                        CPXgetnodeleftcnt(cpxEnv, cpxLp));
+        CPXsetinfocallbackfunc(cpxEnv, NULL, NULL);
+    }
+    if (status != 0)
+    {
+        cout << "Failed to Optimize MIP " << endl;
+        return -1;
+    }
+    return 1;
+}
+
+/// Get the solution of the native model in data structure opt.
+/**
+ * The values are read with one call to CPXgetx for \f$y\f$ and one for
+ * the \f$x\f$ block of each open facility (a closed facility serves no
+ * customer). Only the nonzero allocations are stored.
+ */
+void native_get_solution(INSTANCE & inp, SOLUTION & opt)
+{
+    PHASE_TIMER phase("extract");
+    opt.nOpen = 0;
+    opt.ySol = new int[inp.nF];
+
+    int    stat = CPXgetstat(cpxEnv, cpxLp);
+    double zStar;
+    bool   found = (CPXgetobjval(cpxEnv, cpxLp, &zStar) == 0);
+
+    if (stat == CPXMIP_OPTIMAL || stat == CPXMIP_OPTIMAL_TOL)
+        opt.zStatus = IloAlgorithm::Optimal;
+    else if (stat == CPXMIP_INFEASIBLE)
+        opt.zStatus = IloAlgorithm::Infeasible;
+    else if (stat == CPXMIP_UNBOUNDED)
+        opt.zStatus = IloAlgorithm::Unbounded;
+    else if (stat == CPXMIP_INForUNBD)
+        opt.zStatus = IloAlgorithm::InfeasibleOrUnbounded;
+    else if (found)
+        opt.zStatus = IloAlgorithm::Feasible;
+    else
+        opt.zStatus = IloAlgorithm::Unknown;
+
+    if (!found)
+    {
+        opt.zStar = 0.0;
+        for (int i = 0; i < inp.nF; i++)
+            opt.ySol[i] = 0;
+        opt.xBeg.assign(inp.nC + 1, 0);
+        return;
+    }
+    opt.zStar = zStar;
+
+    // y are the first nF columns, then x row by row (see the description of the file)
+    vector<double> yVal(inp.nF), xVal(inp.nC);
+    native_check(CPXgetx(cpxEnv, cpxLp, yVal.data(), 0, inp.nF-1), "CPXgetx");
+    vector<int>    fac, cus;
+    vector<double> val;
+    for (int i = 0; i < inp.nF; i++)
+    {
+        if (yVal[i] >= 1.0-EPSI)
+        {
+            opt.ySol[i] = 1;
+            opt.nOpen++;
+        }
+        else
+            opt.ySol[i] = 0;
+        if (yVal[i] <= EPSI)
+            continue;
+        int first = inp.nF + i*inp.nC;
+        native_check(CPXgetx(cpxEnv, cpxLp, xVal.data(), first, first + inp.nC-1), "CPXgetx");
+        for (int j = 0; j < inp.nC; j++)
+            if (xVal[j] > 0.0)
+            {
+                fac.push_back(i);
+                cus.push_back(j);
+                val.push_back(xVal[j]);
+            }
+    }
+    solution_set_x(inp, opt, fac, cus, val);
+}
+
+/// Nodes, relative gap and objective value of the last native solve.
+void native_progress(long & nodes, double & gap, double & zStar)
+{
+    nodes = CPXgetnodecnt(cpxEnv, cpxLp);
+    if (CPXgetobjval(cpxEnv, cpxLp, &zStar) != 0 || 
+        CPXgetmiprelgap(cpxEnv, cpxLp, &gap) != 0)
+    {
+        zStar = CPX_INFBOUND;
+        gap   = CPX_INFBOUND;
+    }
+}
+
+/// Write the native model to disk (format given by the file extension).
+void native_export(const char * filename)
+{
+    native_check(CPXwriteprob(cpxEnv, cpxLp, filename, NULL), "CPXwriteprob");
+}
+
+/// Free the native problem and close the callable library environment.
+void native_end()
+{
+    if (cpxLp != NULL)
+        CPXfreeprob(cpxEnv, &cpxLp);
+    if (cpxEnv != NULL)
+        CPXcloseCPLEX(&cpxEnv);
+}
@@ -41,14 +41,122 @@
     - **-r** : read from disk
             -# 0 No: A new Budget set $B_l$ is generated and stored
             -# 1 Yes: The Budget set is read from disk
+
+    - **-b** : model builder
+            -# 0 Concert expressions (default)
+            -# 1 Matrix format, loaded in bulk via the callable library (native.cpp)
+
+    - **-x** : export the model before solving it (gzip-compressed)
+            -# 0 No (default)
+            -# 1 SAV format
+            -# 2 MPS format
+            -# 3 LP format
+
+    - **-X** : name of the exported model file (default: see exportModel())
+
+    - **-a** : compress the exported model in a background thread (0-No; 1-Yes)
+
+    - **-T** : number of cplex threads (default 1; 0 lets cplex use all cores)
+
+    - **-P** : parallel mode
+            -# 1 Deterministic (default)
+            -# -1 Opportunistic
+            -# 0 Chosen by cplex
+
+    - **-S** : thread scaling report: the model is solved with 1, 2, 4, ... up
+               to the given number of threads (see scaleCplexThreads())
+
+    - **-w** : parameter sweep file (robust polyhedral model only): one
+               point per row, with values for epsilon, delta, gamma and L
+               (see sweepCplexProblem())
+
+    - **-m** : solution file (as written in folder "solutions") used as MIP
+               start. It can be repeated to give more than one start.
+
+    - **-n** : nominal start
+               - 0 : no (default)
+               - 1 : the nominal (multi-source) optimum is used as MIP start
+
+    - **-B** : Benders decomposition (Concert builder; -v 2 and -v 4 only,
+               see define_benders())
+               - 0 : no, branch-and-cut (default)
+               - 1 : location variables in the master
+               - 2 : location variables and robust cost in the master
+               - 3 : location and allocation variables in the master, one
+                     subproblem per facility (polyhedral model)
+
+    - **-A** : write the Benders annotation to disk (0-No; 1-Yes)
+
+    - **-C** : compare Benders with branch-and-cut (0-No; 1-Yes)
+
+    - **-c** : compact model when the support has an analytic worst case,
+               e.g., box support (see box_worst_case())
+               - 0 : no, always use the dualized model
+               - 1 : yes (default)
+               - 2 : yes, and check its value against the dualized model
+
+    - **-R** : row generation solver (polyhedral model, Concert builder; see
+               rowgen.cpp)
+               - 0 : no, dualized model (default)
+               - 1 : yes
+               - 2 : yes, and compare time and memory with the dualized model
+
+    - **-H** : construction and local search heuristic (see heuristic.cpp)
+               - 0 : no (default)
+               - 1 : its solution is given to cplex as MIP start
+               - 2 : heuristic only (no model is built)
+
+    - **-F** : preprocessing of the facilities (see preprocess.cpp)
+               - 0 : no (default)
+               - 1 : reduced-cost fixing
+               - 2 : reduced-cost fixing and dominance (heuristic reduction)
+
+    - **-k** : candidate facilities per customer (see candidates.cpp)
+               - 0 : all, i.e., dense model (default)
+               - K : the K cheapest ones, with pricing of the others
+                     (MS and polyhedral models, Concert builder)
+
+    - **-j** : linking rows x_ij <= y_i (see linking.cpp)
+               - 0 : in the model (default)
+               - 1 : separated as user cuts
+               - 2 : dropped
+               - 3 : compare the three (Concert builder)
+
+    - **-q** : manifest of a batch of jobs, one run per line (see batch.cpp);
+               -i and -t are then given in each job
+
+    - **-N** : number of jobs of a batch running at the same time (default 1)
+
+    - **-O** : output directory of a batch (default: batch)
+
+    - **-Y** : trajectory file of the MIP solves: incumbent, bound, gap and
+               nodes over time, in JSONL format if the name ends with
+               `.jsonl`, in csv format otherwise (see trajectory.cpp)
+
+    - **-I** : sampling interval of the trajectory, in seconds (default 1)
+
+    - **-E** : trace file (Chrome trace format) with the wall time, CPU
+               time and peak memory of each phase of the run (see phases.cpp)
+
+    - **-D** : dry run: print the size of the model and its memory
+               estimate, and stop before the build (0-No; 1-Yes)
+
+    - **-M** : memory budget in MB (0: none). If the estimate exceeds it, the
+               run switches to a smaller formulation or stops (see modelsize.cpp)
 */
 
 #include <iostream>
 #include <cstdlib>
+#include <vector>
 /**********************************************************/
 #define   _TIMELIMITdef  18000   //!< default wall-clock time limit
 #define   _VERSIONdef    1      //!< single source by default
 #define   _FROMDISKdef    1      //!< single source by default
+#define   _BUILDERdef     0      //!< Concert builder by default
+#define   _EXPORTdef      0      //!< model is not exported by default
+#define   _THREADSdef     1      //!< sequential solve by default
+#define   _PARALLELdef    1      //!< deterministic parallel mode by default
+#define   _COMPACTdef     1      //!< compact model for box-like supports by default
 /**********************************************************/
 
 using namespace std;
@@ -59,6 +167,33 @@ extern int fType;           //!< instance type (1-2)
 extern int version;         //!< 1-SS; 2-MS; 3-Ellipsoidal; 4-Polyhedral
 extern int support;         //!< 1-Box; 2-Budget
 extern int readFromDisk;    //!< 0-No; (Generate a new Budget set B_l); 1-Yes
+extern int builder;         //!< 0-Concert; 1-Native matrix (callable library)
+extern int exportFormat;    //!< 0-None; 1-SAV; 2-MPS; 3-LP (gzip-compressed)
+extern int exportAsync;     //!< 0-No; 1-Yes (compression of the export in a background thread)
+extern char* _EXPORTNAME;   //!< name of the exported model (NULL: default)
+extern int nThreads;        //!< number of cplex threads (0: all cores)
+extern int parallelMode;    //!< 1-Deterministic; -1-Opportunistic; 0-Auto
+extern int scalingThreads;  //!< max. threads in the scaling report (0: no report)
+extern char* _SWEEPNAME;    //!< parameter sweep file (NULL: no sweep)
+extern vector<char*> _STARTNAMES; //!< solution files used as MIP starts
+extern int nominalStart;    //!< 0-No; 1-Yes (nominal optimum as MIP start)
+extern int bendersMode;     //!< 0-Branch-and-cut; 1-3 Benders partition
+extern int bendersAnnotation; //!< 0-No; 1-Yes (write the annotation)
+extern int bendersCompare;  //!< 0-No; 1-Yes (compare with branch-and-cut)
+extern int compactBox;      //!< 0-No; 1-Yes; 2-Yes, with check
+extern int rowGeneration;   //!< 0-No; 1-Yes; 2-Yes, compared with the dualized model
+extern int heuristicMode;   //!< 0-No; 1-MIP start; 2-Heuristic only
+extern int preprocessLevel; //!< 0-No; 1-Reduced-cost fixing; 2-Also dominance
+extern int candidateK;      //!< Candidate facilities per customer (0: all)
+extern int linkingMode;     //!< 0-In the model; 1-User cuts; 2-Dropped; 3-Compare
+extern char* _MANIFEST;     //!< job manifest of a batch (NULL: single run)
+extern int batchWorkers;    //!< jobs of a batch running at the same time
+extern char* _BATCHDIR;     //!< output directory of a batch
+extern char* _TRAJNAME;     //!< trajectory file (NULL: no trajectory)
+extern double trajInterval; //!< sampling interval of the trajectory (seconds)
+extern char* _TRACENAME;    //!< trace file of the phases (NULL: no trace)
+extern int dryRun;          //!< 0-No; 1-Yes (model size only, no build)
+extern int memoryBudget;    //!< memory budget of the model in MB (0: none)
 extern string instanceType;
 extern string versionType;
 extern string supportType;
@@ -81,6 +216,32 @@ int parseOptions(int argc, char* argv[])
    timeLimit    = _TIMELIMITdef;
    version      = _VERSIONdef;
    readFromDisk= _FROMDISKdef;
+   builder     = _BUILDERdef;
+   exportFormat= _EXPORTdef;
+   exportAsync = 0;
+   nThreads    = _THREADSdef;
+   parallelMode= _PARALLELdef;
+   scalingThreads = 0;
+   _SWEEPNAME = NULL;
+   nominalStart = 0;
+   bendersMode = 0;
+   bendersAnnotation = 0;
+   bendersCompare = 0;
+   compactBox = _COMPACTdef;
+   rowGeneration = 0;
+   heuristicMode = 0;
+   preprocessLevel = 0;
+   candidateK = 0;
+   linkingMode = 0;
+   _MANIFEST = NULL;
+   batchWorkers = 1;
+   _BATCHDIR = (char *) "batch";
+   _TRAJNAME = NULL;
+   trajInterval = 1.0;
+   _TRACENAME = NULL;
+   dryRun = 0;
+   memoryBudget = 0;
+   _STARTNAMES.clear(); // a batch job parses its own options (see batch.cpp)
    cout <<endl << "R-CLSP v1.0 " << endl;
    if (argc == 1)
    {
@@ -134,6 +295,114 @@ int parseOptions(int argc, char* argv[])
 	       readFromDisk = atol(argv[i+1]);
 	       i++;
 	       break;
+        case 'b':
+	       builder = atol(argv[i+1]);
+	       i++;
+	       break;
+        case 'x':
+	       exportFormat = atol(argv[i+1]);
+	       i++;
+	       break;
+        case 'X':
+	       _EXPORTNAME = argv[i+1];
+	       i++;
+	       break;
+        case 'a':
+	       exportAsync = atol(argv[i+1]);
+	       i++;
+	       break;
+        case 'T':
+	       nThreads = atol(argv[i+1]);
+	       i++;
+	       break;
+        case 'P':
+	       parallelMode = atol(argv[i+1]);
+	       i++;
+	       break;
+        case 'S':
+	       scalingThreads = atol(argv[i+1]);
+	       i++;
+	       break;
+        case 'w':
+	       _SWEEPNAME = argv[i+1];
+	       i++;
+	       break;
+        case 'm':
+	       _STARTNAMES.push_back(argv[i+1]);
+	       i++;
+	       break;
+        case 'n':
+	       nominalStart = atol(argv[i+1]);
+	       i++;
+	       break;
+        case 'B':
+	       bendersMode = atol(argv[i+1]);
+	       i++;
+	       break;
+        case 'A':
+	       bendersAnnotation = atol(argv[i+1]);
+	       i++;
+	       break;
+        case 'C':
+	       bendersCompare = atol(argv[i+1]);
+	       i++;
+	       break;
+        case 'c':
+	       compactBox = atol(argv[i+1]);
+	       i++;
+	       break;
+        case 'R':
+	       rowGeneration = atol(argv[i+1]);
+	       i++;
+	       break;
+        case 'H':
+	       heuristicMode = atol(argv[i+1]);
+	       i++;
+	       break;
+        case 'F':
+	       preprocessLevel = atol(argv[i+1]);
+	       i++;
+	       break;
+        case 'k':
+	       candidateK = atol(argv[i+1]);
+	       i++;
+	       break;
+        case 'j':
+	       linkingMode = atol(argv[i+1]);
+	       i++;
+	       break;
+        case 'q':
+	       _MANIFEST = argv[i+1];
+	       i++;
+	       break;
+        case 'N':
+	       batchWorkers = atol(argv[i+1]);
+	       i++;
+	       break;
+        case 'O':
+	       _BATCHDIR = argv[i+1];
+	       i++;
+	       break;
+        case 'Y':
+	       _TRAJNAME = argv[i+1];
+	       i++;
+	       break;
+        case 'I':
+	       trajInterval = atof(argv[i+1]);
+	       i++;
+	       break;
+        case 'E':
+	       _TRACENAME = argv[i+1];
+	       i++;
+	       break;
+        case 'D':
+	       dryRun = atol(argv[i+1]);
+	       i++;
+	       break;
+        case 'M':
+	       memoryBudget = atol(argv[i+1]);
+	       i++;
+	       break;
 
 
 
@@ -167,12 +436,43 @@ int parseOptions(int argc, char* argv[])
 	       cout << "-t : instance type (1-OR Library; 2-Avella)" << endl;
 	       cout << "-u : support type (1-Box; 2-Budget)" << endl;
 	       cout << "-r : read Budget support set from disk (0-No; 1-Yes)" << endl;
+	       cout << "-b : model builder (0-Concert; 1-Native matrix)" << endl;
+	       cout << "-x : export model (0-No; 1-SAV; 2-MPS; 3-LP), gzip-compressed; each file once" << endl;
+	       cout << "     (first solve of a comparison, every point of a sweep without -X)" << endl;
+	       cout << "-X : exported model file name" << endl;
+	       cout << "-a : compress the exported model in background (0-No; 1-Yes)" << endl;
+	       cout << "-T : number of threads (0-All cores)" << endl;
+	       cout << "-P : parallel mode (1-Deterministic; -1-Opportunistic; 0-Auto)" << endl;
+	       cout << "-S : thread scaling report up to the given number of threads" << endl;
+	       cout << "-w : parameter sweep file (rows: epsilon delta gamma L)" << endl;
+	       cout << "-m : solution file used as MIP start (can be repeated)" << endl;
+	       cout << "-n : nominal optimum as MIP start (0-No; 1-Yes)" << endl;
+	       cout << "-B : Benders partition (0-None; 1-y; 2-y,delta; 3-y,x + psi blocks)" << endl;
+	       cout << "-A : write the Benders annotation (0-No; 1-Yes)" << endl;
+	       cout << "-C : compare Benders with branch-and-cut (0-No; 1-Yes)" << endl;
+	       cout << "-c : compact model for box-like supports (0-No; 1-Yes; 2-Yes, checked)" << endl;
+	       cout << "-R : row generation solver (0-No; 1-Yes; 2-Yes, compared with the dualized model)" << endl;
+	       cout << "-H : heuristic (0-No; 1-Yes, as MIP start; 2-Heuristic only)" << endl;
+	       cout << "-F : preprocessing (0-No; 1-Reduced-cost fixing; 2-Also dominance)" << endl;
+	       cout << "-k : candidate facilities per customer, with pricing (0-All)" << endl;
+	       cout << "-j : linking rows (0-In the model; 1-User cuts; 2-Dropped; 3-Compare)" << endl;
+	       cout << "-q : manifest of a batch of jobs (one set of options per line)" << endl;
+	       cout << "-N : jobs of a batch running at the same time (default 1)" << endl;
+	       cout << "-O : output directory of a batch (default: batch)" << endl;
+	       cout << "-Y : trajectory file of the MIP solves (.jsonl: JSONL; otherwise csv)" << endl;
+	       cout << "-I : sampling interval of the trajectory in seconds (default 1)" << endl;
+	       cout << "-E : trace file of the phases of the run (Chrome trace format)" << endl;
+	       cout << "-D : dry run: model size and memory estimate only (0-No; 1-Yes)" << endl;
+	       cout << "-M : memory budget of the model in MB (default 0: none)" << endl;
 	       cout << endl;
 	       return -1;
 	 }
       }
    }
  
+   if (_MANIFEST != NULL) // the instances are given in the jobs (see batch.cpp)
+        return 0;
+
    if (setFile && setType)
    {
         if (fType == 1)
@@ -0,0 +1,171 @@
+/***************************************************************************
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+/*! \file phases.cpp
+  \brief Wall time, CPU time and memory of the phases of a run (flag -E).
+
+ * The phases of a run are measured by scoped timers (PHASE_TIMER), placed
+ * around:
+ * - `read` : reading the instance (readProblemData());
+ * - `starts`, `preprocess`, `heuristic` : MIP starts, preprocessing and
+ *   heuristic, if any;
+ * - `support` : definition of the support (define_box_support() and
+ *   define_budget_support());
+ * - `build` : model construction (it includes `support`);
+ * - `export` : model export (flag -x);
+ * - `solve` : the cplex solves;
+ * - `extract` : getting the solution from cplex;
+ * - `write` : writing the solution to disk.
+ *
+ * For each phase we record the wall-clock time, the CPU time of the process
+ * (user and system, all threads, so that CPU/wall is the parallelism of a
+ * cplex solve) and the peak resident set size of the process at its end.
+ * A phase can be repeated (e.g., one solve per point of a sweep).
+ *
+ * The total wall and CPU time of `read`, `support`, `build`, `export`,
+ * `solve` and `extract` so far, and the peak memory, are appended to the
+ * result row (see writeResultRow()). With **-E** `file`, all the phases are
+ * also written to `file` in the Chrome trace format (one complete event per
+ * phase, nested by time, plus a counter with the peak memory), which can
+ * be opened with `chrome://tracing` or Perfetto.
+ */
+
+#include <iostream>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <sys/resource.h>
+#include <unistd.h>
+
+#include "phases.h"
+#include "writer.h"
+
+using namespace std;
+
+
+/// A phase of the run (see the description of the file)
+struct PHASE {
+    const char *name;
+    int    depth;  //!< Number of enclosing phases
+    double start;  //!< Start (wall-clock seconds from the start of the run)
+    double wall;   //!< Wall-clock time (seconds)
+    double cpu;    //!< CPU time of the process (seconds)
+    double rss;    //!< Peak resident set size at the end of the phase (MB)
+};
+
+vector<PHASE> phases;  //!< Phases of the run, in order of start
+int phaseDepth = 0;    //!< Number of phases currently open
+const chrono::steady_clock::time_point phaseOrigin = chrono::steady_clock::now();
+
+/// Phases reported in the result row
+const char * rowPhases[] = {"read", "support", "build", "export", "solve", "extract"};
+
+
+/// Wall-clock seconds from the start of the run
+double phase_clock()
+{
+    return chrono::duration<double>(chrono::steady_clock::now() - phaseOrigin).count();
+}
+
+/// CPU time (user and system, all threads) and peak memory (MB) of the process
+void phase_usage(double & cpu, double & rss)
+{
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    cpu = usage.ru_utime.tv_sec + usage.ru_stime.tv_sec
+        + (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec)*1e-6;
+    rss = usage.ru_maxrss/1024.0;
+}
+
+PHASE_TIMER::PHASE_TIMER(const char * name)
+{
+    double rss;
+    phase_usage(cpu0, rss);
+    k = phases.size();
+    phases.push_back({name, phaseDepth++, phase_clock(), 0.0, 0.0, 0.0});
+}
+
+PHASE_TIMER::~PHASE_TIMER()
+{
+    double cpu;
+    PHASE & phase = phases[k];
+    phase_usage(cpu, phase.rss);
+    phase.wall = phase_clock() - phase.start;
+    phase.cpu  = cpu - cpu0;
+    phaseDepth--;
+}
+
+/// Append the time spent in each phase so far to the result row (see writeResultRow())
+/** For each phase: wall-clock and CPU time; then the peak memory (MB). */
+void phase_row(ostream & fWriter)
+{
+    for (const char * name : rowPhases)
+    {
+        double wall = 0.0, cpu = 0.0;
+        for (PHASE & phase : phases)
+            if (strcmp(phase.name, name) == 0)
+            {
+                wall += phase.wall;
+                cpu  += phase.cpu;
+            }
+        fWriter << wall << ";" << cpu << ";";
+    }
+    double cpu, rss;
+    phase_usage(cpu, rss);
+    fWriter << rss << ";";
+}
+
+/// Write the phases in the Chrome trace format (flag -E)
+/**
+ * Times are in microseconds. Each phase is a complete event (`"ph":"X"`)
+ * with its CPU time and peak memory as arguments, and the peak memory is
+ * also given as a counter (`"ph":"C"`) at the end of each phase. Phases
+ * still open (e.g., `solve` if the run is stopped) are closed at the time
+ * of writing.
+ */
+void phase_trace(const char * filename)
+{
+    if (filename == NULL)
+        return;
+    WRITER fWriter(filename);
+    if (!fWriter.good())
+    {
+        cout << "[** Cannot open trace file '" << filename << "']" << endl;
+        return;
+    }
+    long pid = getpid();
+    double now = phase_clock();
+    fWriter << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    fWriter << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":" << pid
+            << ",\"args\":{\"name\":\"rcflp\"}}";
+    for (PHASE & phase : phases)
+    {
+        double wall = (phase.rss > 0.0) ? phase.wall : now - phase.start; // rss: 0 if open
+        fWriter << ",\n{\"name\":\"" << phase.name << "\",\"cat\":\"phase\",\"ph\":\"X\",\"pid\":"
+                << pid << ",\"tid\":1,\"ts\":" << 1e6*phase.start << ",\"dur\":" << 1e6*wall
+                << ",\"args\":{\"cpu\":" << phase.cpu << ",\"peak_rss_mb\":" << phase.rss
+                << ",\"depth\":" << phase.depth << "}}";
+        if (phase.rss > 0.0)
+            fWriter << ",\n{\"name\":\"peak RSS (MB)\",\"ph\":\"C\",\"pid\":" << pid
+                    << ",\"ts\":" << 1e6*(phase.start + wall) << ",\"args\":{\"MB\":"
+                    << phase.rss << "}}";
+    }
+    fWriter << "\n]}\n";
+    fWriter.close();
+    cout << "Phase trace written to disk. ('" << filename << "')" << endl;
+}
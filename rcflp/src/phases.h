@@ -0,0 +1,34 @@
+/***************************************************************************
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+/*! \file phases.h
+\brief Header file of phases.cpp
+
+*/
+#include <ostream>
+
+/// Scoped timer: the phase lasts as long as the object (see phases.cpp)
+struct PHASE_TIMER {
+    int    k;     //!< Index of the phase in the list of phases
+    double cpu0;  //!< CPU time of the process at the start of the phase
+
+    PHASE_TIMER(const char * name);
+    ~PHASE_TIMER();
+};
+
+void phase_row(std::ostream & fWriter);
+void phase_trace(const char * filename);
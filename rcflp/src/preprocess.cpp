@@ -0,0 +1,279 @@
+/***************************************************************************
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+/*! \file preprocess.cpp
+  \brief Preprocessing of the facilities (reduced-cost fixing and dominance).
+
+ * The preprocessing is activated with the command line flag **-F**, and it
+ * is done before the model is built. Facilities that can be closed are
+ * removed from the instance, so that the model (of any version, with any
+ * builder) has fewer \f$y\f$, \f$x\f$ and \f$\psi\f$ variables and fewer
+ * capacity and linking rows. The solution is then expanded back to the
+ * original facilities (see preprocess_expand()).
+ *
+ * - **-F 1** : reduced-cost fixing. We solve the LP relaxation of the
+ *   multi-source model with a demand \f$\hat{d}\f$ such that this model is a
+ *   relaxation of the selected version, and we get an upper bound \f$UB\f$
+ *   from the heuristic (see heuristic.cpp). If \f$z_{LP} + \bar{c}_i > UB\f$,
+ *   where \f$\bar{c}_i\f$ is the reduced cost of \f$y_i\f$, no solution
+ *   better than the heuristic one opens facility \f$i\f$, which can thus be
+ *   removed. The heuristic solution is given to cplex as MIP start, so the
+ *   optimal value is not affected.
+ *   We use the nominal demand \f$\hat{d} = d\f$ for versions 1-3 and for the
+ *   box support, which contain it. A budget support does not contain it when
+ *   \f$\delta < 1\f$, and we use its lower bound
+ *   \f$\hat{d} = (1-\epsilon)d\f$ instead: both the cost and the load of
+ *   the facilities grow with the demand, so the model with \f$\hat{d}\f$ is
+ *   a relaxation whether or not \f$\hat{d}\f$ belongs to the support.
+ * - **-F 2** : as 1, plus dominance. Facility \f$k\f$ is dominated by \f$i\f$ if
+ *   \f$f_i \leq f_k\f$, \f$s_i \geq s_k\f$ and \f$c_{ij} \leq c_{kj}\f$ for all
+ *   customers. A solution opening \f$k\f$ but not \f$i\f$ is improved by
+ *   moving everything from \f$k\f$ to \f$i\f$, but solutions opening both
+ *   are lost: this reduction is a heuristic one, and the final value might
+ *   be slightly worse than the optimal one.
+ */
+
+#include <ilcplex/ilocplex.h>
+ILOSTLBEGIN
+
+#include <iostream>
+#include <iomanip>
+#include <cstdlib>
+#include <vector>
+#include <chrono>
+
+#include "phases.h"
+
+using namespace std;
+
+
+struct INSTANCE { /// See same data structure define in rcflp.cpp
+    int nF;
+    int nC;
+    double  *f;
+    double  *s;
+    double  *d;
+    double **c;
+    double  *cT;   // costs in customer-major format (cT[j*nF+i])
+    double   totS;
+    double   totD;
+
+    int nR;        // number of constraints polyhedron uncertainty set
+    double  *h;    // rhs of polyhedron definining support
+    int     *W;    // matrix W in column major format
+    int *index;    // index of column major format for w
+    int *start;    // starting position for elements of column j
+};
+
+struct SOLUTION { /// See same data structure define in rcflp.cpp
+    int nOpen;
+    int  *ySol;
+    vector<int>    xBeg;  // customer-major sparse allocations (see rcflp.cpp)
+    vector<int>    xFac;
+    vector<double> xVal;
+    double zStar;
+    IloAlgorithm::Status zStatus;
+    IloNum startTime;
+    IloNum cpuTime;
+};
+
+typedef IloArray <IloNumVarArray> TwoD;
+extern IloNumVarArray y_ilo;
+extern IloEnv env;
+extern int nThreads;
+extern int fType;
+extern int timeLimit;
+extern int version;
+extern int support;
+extern double _epsilon;
+const double EPSI = 0.00001;
+
+void define_MS_CFLP(INSTANCE & inp, int fType, IloModel & model, IloCplex & cplex);
+void model_reduction(INSTANCE & full, INSTANCE & red);
+void heuristic_parameters();
+bool heuristic_solve(INSTANCE & inp, SOLUTION & sol, double timeLimit);
+
+
+/// Reduced-cost fixing (see the description of the file)
+/**
+ * Sets `keep[i] = 0` for the facilities that can be removed, and returns
+ * their number. The heuristic solution goes in `sol`.
+ */
+int preprocess_reduced_costs(INSTANCE & inp, vector<char> & keep, SOLUTION & sol)
+{
+    heuristic_parameters();
+    if (!heuristic_solve(inp, sol, max(1, timeLimit/10)))
+        return 0;
+    double UB = sol.zStar;
+
+    // demand of the relaxation (see the description of the file)
+    INSTANCE lpInp = inp;
+    vector<double> dLow;
+    if (version == 4 && support == 2)
+    {
+        dLow.resize(inp.nC);
+        for (int j = 0; j < inp.nC; j++)
+            dLow[j] = inp.d[j]*(1.0-_epsilon);
+        lpInp.d = dLow.data();
+    }
+
+    IloModel lpModel(env, "cflp-lp");
+    IloCplex lpCplex(lpModel);
+    define_MS_CFLP(lpInp, fType, lpModel, lpCplex);
+    lpModel.add(IloConversion(env, y_ilo, ILOFLOAT));
+    lpCplex.setOut(env.getNullStream());
+    lpCplex.setParam(IloCplex::Param::Threads, nThreads);
+
+    int nFixed = 0;
+    if (lpCplex.solve())
+    {
+        double zLP = lpCplex.getObjValue();
+        IloNumArray rc(env);
+        lpCplex.getReducedCosts(rc, y_ilo);
+        for (int i = 0; i < inp.nF; i++)
+            if (zLP + rc[i] > UB + EPSI*max(1.0, UB) && sol.ySol[i] == 0)
+            {
+                keep[i] = 0;
+                nFixed++;
+            }
+        rc.end();
+        cout << "[** Preprocessing :: z LP = " << setprecision(15) << zLP
+             << (dLow.empty() ? "" : " (demand at its lower bound)") << "; UB = "
+             << UB << setprecision(6) << "; " << nFixed
+             << " facilities fixed to zero by reduced cost]" << endl;
+    }
+    lpCplex.end();
+    lpModel.end();
+    return nFixed;
+}
+
+/// Dominance (see the description of the file). Returns the number of facilities removed.
+int preprocess_dominance(INSTANCE & inp, vector<char> & keep)
+{
+    int nDominated = 0;
+    for (int k = 0; k < inp.nF; k++)
+    {
+        if (!keep[k])
+            continue;
+        for (int i = 0; i < inp.nF; i++)
+        {
+            if (i == k || !keep[i] || inp.f[i] > inp.f[k] || inp.s[i] < inp.s[k])
+                continue;
+            bool equal = (inp.f[i] == inp.f[k] && inp.s[i] == inp.s[k]);
+            int j = 0;
+            for (; j < inp.nC && inp.c[i][j] <= inp.c[k][j]; j++)
+                if (inp.c[i][j] < inp.c[k][j])
+                    equal = false;
+            if (j < inp.nC || (equal && i > k))
+                continue;
+            keep[k] = 0;
+            nDominated++;
+            break;
+        }
+    }
+    cout << "[** Preprocessing :: " << nDominated << " dominated facilities removed]" << endl;
+    return nDominated;
+}
+
+/// Preprocessing of the facilities (flag -F)
+/**
+ * The facilities which are kept are stored in `keep` (original indices).
+ * If any facility is removed, the reduced instance is stored in `red`
+ * (the cost rows are shared with `inp`) and true is returned. The
+ * heuristic solution (if any) is returned in `sol`, in terms of the
+ * original facilities.
+ */
+bool preprocess_facilities(INSTANCE & inp, int level, vector<int> & keep, INSTANCE & red,
+                           SOLUTION & sol)
+{
+    PHASE_TIMER phase("preprocess");
+    auto start = chrono::system_clock::now();
+    vector<char> kept(inp.nF, 1);
+    sol.ySol = NULL;
+    int nRemoved = preprocess_reduced_costs(inp, kept, sol);
+    if (level >= 2)
+        nRemoved += preprocess_dominance(inp, kept);
+
+    keep.clear();
+    for (int i = 0; i < inp.nF; i++)
+        if (kept[i])
+            keep.push_back(i);
+
+    long nVars = (long)nRemoved*(inp.nC + 1);
+    cout << "[** Preprocessing :: " << nRemoved << " of " << inp.nF
+         << " facilities removed (" << nVars << " location/allocation variables) in "
+         << setprecision(4) << chrono::duration<double>(chrono::system_clock::now()-start).count()
+         << " s]" << setprecision(6) << endl;
+    if (nRemoved == 0)
+        return false;
+
+    red      = inp;
+    red.nF   = keep.size();
+    red.f    = new double[red.nF];
+    red.s    = new double[red.nF];
+    red.c    = new double*[red.nF];
+    red.cT   = NULL;
+    red.totS = 0.0;
+    red.nR   = 0;
+    red.h    = NULL;
+    red.W    = NULL;
+    red.index = NULL;
+    red.start = NULL;
+    for (int k = 0; k < red.nF; k++)
+    {
+        red.f[k] = inp.f[keep[k]];
+        red.s[k] = inp.s[keep[k]];
+        red.c[k] = inp.c[keep[k]];
+        red.totS += red.s[k];
+    }
+    model_reduction(inp, red);
+    return true;
+}
+
+/// Map a solution of the full instance to the reduced one (false if it uses a removed facility)
+bool preprocess_restrict(INSTANCE & red, vector<int> & keep, SOLUTION & sol)
+{
+    int nOpen = 0;
+    for (int k = 0; k < red.nF; k++)
+        nOpen += sol.ySol[keep[k]];
+    if (nOpen < sol.nOpen)
+        return false;
+
+    vector<int> pos(keep.empty() ? 0 : keep.back() + 1, -1);
+    for (int k = 0; k < red.nF; k++)
+        pos[keep[k]] = k;
+    for (unsigned k = 0; k < sol.xFac.size(); k++)
+        if (sol.xFac[k] >= (int) pos.size() || pos[sol.xFac[k]] < 0)
+            return false;
+
+    for (int k = 0; k < red.nF; k++)
+        sol.ySol[k] = sol.ySol[keep[k]];
+    for (unsigned k = 0; k < sol.xFac.size(); k++)
+        sol.xFac[k] = pos[sol.xFac[k]];
+    return true;
+}
+
+/// Expand a solution of the reduced instance to the full one
+void preprocess_expand(INSTANCE & full, vector<int> & keep, SOLUTION & opt)
+{
+    int * ySol = new int[full.nF]();
+    for (int k = 0; k < (int) keep.size(); k++)
+        ySol[keep[k]] = opt.ySol[k];
+    for (unsigned k = 0; k < opt.xFac.size(); k++)
+        opt.xFac[k] = keep[opt.xFac[k]];
+    opt.ySol = ySol;
+}
@@ -37,6 +37,19 @@
   - inout.cpp: Managing the input/output. Here we both read the instance and 
                define the support sets.
   - rcflp.cpp: Main implementation of the CFLP models.
+  - native.cpp: The same models, built in matrix format with the CPLEX
+                callable library (flag **-b 1**).
+  - heuristic.cpp: Construction and local search heuristic (flag **-H**).
+  - preprocess.cpp: Removal of facilities before the model is built (flag **-F**).
+  - candidates.cpp: Sparse allocation variables with pricing (flag **-k**).
+  - linking.cpp: Linking rows in the model, separated or dropped (flag **-j**).
+  - batch.cpp: Batch of jobs solved by a pool of worker processes (flag **-q**).
+  - writer.cpp: Buffered writer of the solution files.
+  - trajectory.cpp: Progress trajectory of the MIP solves (flag **-Y**).
+  - phases.cpp: Time and memory of the phases of a run (flag **-E**).
+  - modelsize.cpp: Size and memory estimate of the model, dry run and memory budget (flags **-D** and **-M**).
+  - rowgen.cpp: Row generation solver for the polyhedral model, with the
+                worst-case demand found in a lazy constraint callback (flag **-R**).
 
   \file rcflp.cpp
   \brief General Implementation of the compact formulations for the (R)-CFLP.
@@ -61,6 +74,11 @@
   - 1 : OR Library instances
   - 2 : Avella instances (Type 1, Type A, Type B)
 
+  Both types can be converted once into a binary format with the
+  InstanceConverter tool. Binary files are recognized automatically (whatever
+  the **-t** flag) and are mapped in memory instead of being parsed, so that
+  concurrent runs on the same instance share a single copy of the data.
+
   __Note__: These instances define the costs in different ways and, therefore
   the way in which the \f$x_{ij}\f$ variables are defined changes. More precisely:
   - For the OR Library instances, the \f$c_{ij}\f$ values are the cost of delivering
@@ -102,7 +120,7 @@
   We use __cplex branch-and-cut__ to solve the different programs. 
 
   In addition, we can also use __cplex Benders__ as implemented in this version 
-  of the solver. To activate Benders, see define_benders().
+  of the solver (flag **-B**). See define_benders().
   
   See the makefile to determine how 
   to link the library to the code.
@@ -130,9 +148,18 @@ ILOSTLBEGIN
 #include <algorithm>
 #include <cstdlib>
 #include <sstream>
+#include <sys/resource.h>
+#include <set>
+#include <thread>
+#include <atomic>
+#include <spawn.h>
+#include <sys/wait.h>
+#include <unistd.h>
 
 /* #include "timer.h" */
 #include "options.h"
+#include "writer.h"
+#include "phases.h"
 
 using namespace std;
 
@@ -150,6 +177,42 @@ int fType;              //!< instance type (1-4)
 int version;            //!< 1-SS; 2-MS; 3-SOCP
 int support;            //!< 1-Box; 2-Budget
 int readFromDisk;       //!< 0-No; (Generate a new Budget set B_l); 1-Yes
+int builder;            //!< 0-Concert; 1-Native matrix (callable library)
+int nThreads;           //!< Number of cplex threads (0: all cores)
+int parallelMode;       //!< 1-Deterministic; -1-Opportunistic; 0-Auto
+int scalingThreads;     //!< Max. number of threads in the scaling report (0: no report)
+char * _SWEEPNAME;      //!< File with the points of a parameter sweep (NULL: no sweep)
+vector<char *> _STARTNAMES; //!< Solution files used as MIP starts (flag -m)
+int nominalStart;       //!< 0-No; 1-Yes (nominal optimum used as MIP start)
+int bendersMode;        //!< 0-Branch-and-cut; 1-Benders (y); 2-(y,delta); 3-(y,x) + psi blocks
+int bendersAnnotation;  //!< 0-No; 1-Yes (write the Benders annotation to disk)
+int bendersCompare;     //!< 0-No; 1-Yes (compare Benders with branch-and-cut)
+int compactBox;         //!< 0-No; 1-Yes; 2-Yes, checked against the dualized model
+bool compactBuilt = false; //!< true if the last polyhedral model is the compact one
+int rowGeneration;      //!< 0-No; 1-Row generation (-v 4); 2-Yes, compared with the dualized model
+int heuristicMode;      //!< 0-No; 1-Heuristic solution as MIP start; 2-Heuristic only
+double heurValue = -1;  //!< Value of the heuristic solution (-1 if none)
+double heurTime  = 0;   //!< Time spent in the heuristic (seconds)
+int preprocessLevel;    //!< 0-No; 1-Reduced-cost fixing; 2-Reduced-cost fixing and dominance
+int candidateK;         //!< Candidate facilities per customer (0: all, i.e., dense model)
+vector<char> candidate; //!< candidate[i*nC+j] = 1 if x_ij is in the model (empty: all)
+int candidateModel = 0; //!< Model the candidate lists refer to (2-MS; 4-Dualized)
+vector<double> msDemand;   //!< Demand used by the last MS model (see define_POLY_CFLP())
+int linkingMode;        //!< Linking rows: 0-In the model; 1-User cuts; 2-Dropped; 3-Compare
+char * _MANIFEST;       //!< Job manifest of a batch (NULL: single run)
+int batchWorkers;       //!< Number of jobs of a batch running at the same time
+char * _BATCHDIR;       //!< Output directory of a batch
+char * _TRAJNAME;       //!< Trajectory file of the MIP solves (NULL: no trajectory)
+double trajInterval;    //!< Sampling interval of the trajectory (seconds)
+char * _TRACENAME;      //!< Trace file of the phases of the run (NULL: no trace)
+int dryRun;             //!< 0-No; 1-Yes (model size only, no build)
+int memoryBudget;       //!< Memory budget of the model in MB (0: none)
+double modelEstimate = 0; //!< Estimated memory of the model in MB (see modelsize.cpp)
+int exportFormat;       //!< 0-None; 1-SAV; 2-MPS; 3-LP (gzip-compressed)
+int exportAsync;        //!< 0-No; 1-Yes (compression of the export in a background thread)
+char * _EXPORTNAME;     //!< Name of the exported model (NULL: default name)
+vector<thread> exportThreads; //!< Background compressions of the exported models
+atomic<int> exportFailed(0);  //!< Number of background compressions that failed
 string instanceType;
 string versionType;
 string supportType;
@@ -177,7 +240,8 @@ struct INSTANCE {
     double  *f;    //!< Fixed costs
     double  *s;    //!< Capacity
     double  *d;    //!< Demand
-    double **c;    //!< Allocation costs
+    double **c;    //!< Allocation costs (rows of one contiguous block)
+    double  *cT;   //!< Allocation costs, customer-major (cT[j*nF+i])
     double   totS; //!< Total supply
     double   totD; //!< Total demand
 
@@ -191,16 +255,26 @@ struct INSTANCE {
 INSTANCE inp; //!< Instance data
 
 /// Optimal solution and obj function value
+/**
+ * The allocations are stored in customer-major sparse format: customer
+ * \f$j\f$ is served by facilities `xFac[k]`, with fractions `xVal[k]`,
+ * for \f$k\f$ = `xBeg[j]`, ..., `xBeg[j+1]-1`. Only nonzero allocations
+ * are stored; for single-source solutions, `xFac` is the assignment vector.
+ */
 struct SOLUTION {
     int nOpen;
     int  *ySol;
-    double **xSol;
+    vector<int>    xBeg;  //!< first allocation of each customer (nC+1 elements)
+    vector<int>    xFac;  //!< facility of each allocation
+    vector<double> xVal;  //!< fraction of the demand of each allocation
     double zStar;
     IloAlgorithm::Status zStatus;
     IloNum startTime;
     IloNum cpuTime;
 };
 SOLUTION opt; //!< Solution data structure
+vector<SOLUTION> starts;  //!< Solutions given to cplex as MIP starts
+vector<string> startNames; //!< Origin of each MIP start (file name or "nominal")
 
 
 /**** CPLEX DEFINITION ****/
@@ -215,20 +289,77 @@ IloNumVar w_ilo;
 TwoD psi_ilo;
 IloNumVarArray u_ilo;
 IloNumVarArray delta_ilo;
+IloRangeArray rob_cap_ilo; //!< robust capacity rows (coefficients h on psi)
+IloRange rob_delta_ilo;    //!< robust objective row (coefficients h on u)
+IloRangeArray demand_ilo;  //!< demand rows (MS and dualized models)
+IloRangeArray cap_ilo;     //!< capacity rows (MS model)
+IloArray<IloRangeArray> rob_dem_ilo; //!< rows W*psi >= x (dualized model)
+IloRangeArray rob_obj_ilo; //!< rows W*u >= c*x (dualized model)
+IloObjective obj_ilo;      //!< objective function (MS model)
 int solLimit     = 9999;
 int displayLimit = 4;
 int timeLimit;
 
 /****************** FUNCTIONS DECLARATION ***************************/
 int readProblemData(char * _FILENAME, int fType, INSTANCE & inp);
-void printOptions(char * _FILENAME, INSTANCE inp, int timeLimit);
-void define_MS_CFLP(INSTANCE inp, int fType, IloModel & model, IloCplex & cplex);
-void define_SS_CFLP(INSTANCE inp, int fType, IloModel & model, IloCplex & cplex);
-void define_SOCP_CFLP(INSTANCE inp, int fType, IloModel & model, IloCplex & cplex);
-void define_POLY_CFLP(INSTANCE inp, int fType, IloModel & model, IloCplex & cplex, int support);
-int solveCplexProblem(IloModel model, IloCplex cplex, INSTANCE inp, int solLimit, int timeLimit, int displayLimit);
-void getCplexSol(INSTANCE inp, IloCplex cplex, SOLUTION & opt);
-void printSolution(char * _FILENAME, INSTANCE inp, SOLUTION opt, bool toDisk, int fullOutput);
+void printOptions(char * _FILENAME, INSTANCE & inp, int timeLimit);
+void define_customer_major(INSTANCE & inp);
+void define_MS_CFLP(INSTANCE & inp, int fType, IloModel & model, IloCplex & cplex);
+void define_SS_CFLP(INSTANCE & inp, int fType, IloModel & model, IloCplex & cplex);
+void define_SOCP_CFLP(INSTANCE & inp, int fType, IloModel & model, IloCplex & cplex);
+void define_POLY_CFLP(INSTANCE & inp, int fType, IloModel & model, IloCplex & cplex, int support);
+void define_DUAL_CFLP(INSTANCE & inp, IloModel & model);
+bool box_worst_case(INSTANCE & inp, vector<double> & dMax);
+void verifyCompactModel(INSTANCE & inp, SOLUTION & opt);
+void rowgen_define_CFLP(INSTANCE & inp, IloModel & model, IloCplex & cplex, int support);
+double rowgen_peak_memory();
+void rowgen_compare(INSTANCE & inp, SOLUTION & opt, chrono::system_clock::time_point start,
+                    double rgPeak, bool compare);
+int solveCplexProblem(IloModel model, IloCplex cplex, INSTANCE & inp, int solLimit, int timeLimit, int displayLimit);
+void getCplexSol(INSTANCE & inp, IloCplex cplex, SOLUTION & opt);
+void writeSolution(INSTANCE & inp, SOLUTION & opt);
+void printBuildInfo(chrono::system_clock::time_point start);
+void native_define_CFLP(INSTANCE & inp, int version, int support);
+int native_solve(int solLimit, int timeLimit, int displayLimit);
+void native_get_solution(INSTANCE & inp, SOLUTION & opt);
+void native_end();
+void native_export(const char * filename);
+void exportModel(IloCplex * cplex);
+void native_progress(long & nodes, double & gap, double & zStar);
+void scaleCplexThreads(IloCplex * cplex, INSTANCE & inp);
+void waitExport();
+void writeResultRow(ostream & fWriter, INSTANCE & inp, SOLUTION & opt);
+int read_sweep_points(char * _SWEEPNAME, vector<double> & eps, vector<double> & del,
+                      vector<double> & gam, vector<int> & ell);
+void update_support_rhs(INSTANCE & inp);
+void update_POLY_CFLP(INSTANCE & inp);
+int model_check(INSTANCE & inp);
+void sweepCplexProblem(INSTANCE & inp);
+bool readSolution(char * _SOLNAME, INSTANCE & inp, SOLUTION & sol);
+bool solveNominalStart(INSTANCE & inp, SOLUTION & sol);
+void prepareMIPStarts(INSTANCE & inp);
+int repairStart(INSTANCE & inp, SOLUTION & sol);
+void addMIPStarts(IloCplex & cplex, INSTANCE & inp);
+void resetMIPStarts(IloCplex & cplex, INSTANCE & inp);
+void native_add_start(INSTANCE & inp, SOLUTION & sol);
+void heuristic_parameters();
+bool heuristic_solve(INSTANCE & inp, SOLUTION & sol, double timeLimit);
+void heuristicStart(INSTANCE & inp);
+bool preprocess_facilities(INSTANCE & inp, int level, vector<int> & keep, INSTANCE & red,
+                           SOLUTION & sol);
+bool preprocess_restrict(INSTANCE & red, vector<int> & keep, SOLUTION & sol);
+void preprocess_expand(INSTANCE & full, vector<int> & keep, SOLUTION & opt);
+bool isCandidate(INSTANCE & inp, int i, int j);
+void candidate_lists(INSTANCE & inp, int k);
+void solveCandidateProblem(IloModel & model, IloCplex & cplex, INSTANCE & inp);
+void linking_rows(INSTANCE & inp, IloModel & model);
+void linking_use(IloCplex & cplex, INSTANCE & inp);
+void compareLinking(IloCplex & cplex, INSTANCE & inp);
+bool trajectory_use(IloCplex & cplex, IloCplex::Callback & cb);
+void trajectory_end(IloCplex & cplex, IloCplex::Callback & cb);
+int batch_run(char * _MANIFEST, int nWorkers, char * _BATCHDIR);
+int solve_instance();
+void printSolution(char * _FILENAME, INSTANCE & inp, SOLUTION & opt, bool toDisk, int fullOutput);
 /* void read_parameters_box(double & _delta); */
 void read_parameters_box();
 void read_parameters_ellipsoidal();
@@ -239,7 +370,8 @@ void save_instance_2_disk(double _epsilon, double _delta, double _gamma, int L,
                           int nBl, int ** Bl, double * budget);
 void read_instance_from_disk(double & _epsilon, double & _delta, double & _gamma, 
                              int & L, int & nBl, int ** Bl, double * budget);
-void define_benders(IloModel & model, IloCplex & cplex, INSTANCE inp);
+bool define_benders(IloCplex & cplex, INSTANCE & inp);
+void compareBenders(IloCplex & cplex, INSTANCE & inp);
 /****************** FUNCTIONS DECLARATION ***************************/
 
 /************************ main program ******************************/
@@ -247,50 +379,237 @@ void define_benders(IloModel & model, IloCplex & cplex, INSTANCE inp);
 /************************ main program ******************************/
 int main(int argc, char *argv[])
 {
-    _epsilon = 0.0;
-    _delta   = 0.0;
-    _gamma   = 0.0;
-    L        = 0;
     std::srand ( unsigned ( std::time(0) ) );
 
     int err = parseOptions(argc, argv);
     if (err != 0) exit(1);
 
+    if (_MANIFEST != NULL) // batch of jobs (see batch.cpp)
+        return batch_run(_MANIFEST, batchWorkers, _BATCHDIR);
+
+    return solve_instance();
+}
+
+/// Read and solve the instance given by the options (also one job of a batch)
+int solve_instance()
+{
+    _epsilon = 0.0;
+    _delta   = 0.0;
+    _gamma   = 0.0;
+    L        = 0;
+
     readProblemData(_FILENAME, fType, inp);
     printOptions(_FILENAME, inp, timeLimit);
 
+    // must be done before the model is defined (see solveNominalStart())
+    prepareMIPStarts(inp);
+
+    if (_SWEEPNAME != NULL) // parameter sweep (robust polyhedral model only)
+    {
+        sweepCplexProblem(inp);
+        waitExport();
+        phase_trace(_TRACENAME);
+        env.end();
+        return 0;
+    }
+
     auto start = chrono::system_clock::now();
 
-    IloCplex cplex(model);
-    switch(version)
+    if (heuristicMode == 2) // heuristic only (no model is built)
     {
-        case 1 :  // single source nominal
-            define_SS_CFLP(inp, fType, model, cplex);
-            break;
-        case 2 : // multi source nominal
-            define_MS_CFLP(inp, fType, model, cplex);
-            break;
-        case 3 : // multi source ellipsoidal
-            define_SOCP_CFLP(inp, fType, model, cplex);
-            break;
-        case 4 : // robust polyhedral uncertainty set (both SS and MS)
-            define_POLY_CFLP(inp, fType, model, cplex, support);
-            break;
-        default :
-            cout << "ERROR : Version type not defined.\n" << endl;
-            exit(123);
+        heuristic_parameters();
+        if (!heuristic_solve(inp, opt, timeLimit))
+        {
+            env.end();
+            return 1;
+        }
+        opt.cpuTime = chrono::duration<double>(chrono::system_clock::now()-start).count();
+        writeSolution(inp, opt);
+        printSolution(_FILENAME, inp, opt, true, 1);
+        phase_trace(_TRACENAME);
+        env.end();
+        return 0;
+    }
+
+    // preprocessing (flag -F): the model is built on the reduced instance
+    INSTANCE full = inp;
+    vector<int> keep;
+    bool reduced = false;
+    if (preprocessLevel > 0)
+    {
+        INSTANCE red;
+        SOLUTION hSol;
+        reduced = preprocess_facilities(inp, preprocessLevel, keep, red, hSol);
+        if (hSol.ySol != NULL)
+        {
+            heurValue = hSol.zStar;
+            heurTime  = hSol.cpuTime;
+            starts.push_back(hSol);
+            startNames.push_back("heuristic");
+        }
+        if (reduced)
+        {
+            for (int k = starts.size()-1; k >= 0; k--)
+                if (!preprocess_restrict(red, keep, starts[k]))
+                {
+                    cout << "[** MIP start '" << startNames[k] 
+                         << "' opens a removed facility: ignored]" << endl;
+                    starts.erase(starts.begin() + k);
+                    startNames.erase(startNames.begin() + k);
+                }
+            inp = red;
+        }
+    }
+
+    if (linkingMode == 3 && (builder == 1 || bendersMode > 0 || candidateK > 0))
+    {
+        cout << "[** Linking comparison (-j 3) needs the Concert builder, without Benders "
+             << "and candidate lists: linking rows in the model]" << endl;
+        linkingMode = 0;
+    }
+    if (linkingMode == 1 && bendersMode > 0)
+    {
+        cout << "[** Linking user cuts (-j 1) are not used with Benders: "
+             << "linking rows in the model]" << endl;
+        linkingMode = 0;
+    }
+
+    if (candidateK > 0)
+    {
+        if (builder == 1 || rowGeneration > 0 || (version != 2 && version != 4))
+        {
+            cout << "[** Candidate lists (-k) need the MS or polyhedral model (Concert builder, "
+                 << "no row generation): ignored]" << endl;
+            candidateK = 0;
+        }
+        else
+            candidate_lists(inp, candidateK);
+    }
+
+    // size and memory estimate of the model (flags -D and -M, see modelsize.cpp)
+    int check = model_check(inp);
+    if (check <= 0)
+    {
+        phase_trace(_TRACENAME);
+        env.end();
+        return check < 0 ? 1 : 0;
+    }
+
+    if (builder == 1) // matrix-based model (see native.cpp)
+    {
+        {
+            PHASE_TIMER phase("build");
+            native_define_CFLP(inp, version, support);
+        }
+        printBuildInfo(start);
+        if (heuristicMode == 1 && heurValue < 0)
+            heuristicStart(inp);
+
+        for (int k = 0; k < (int) starts.size(); k++)
+        {
+            repairStart(inp, starts[k]);
+            native_add_start(inp, starts[k]);
+        }
+        if (bendersMode > 0)
+            cout << "[** Benders (-B) requires the Concert builder: ignored]" << endl;
+        if (rowGeneration > 0)
+            cout << "[** Row generation (-R) requires the Concert builder: ignored]" << endl;
+
+        if (scalingThreads > 0)
+            scaleCplexThreads(NULL, inp);
+        else
+            native_solve(solLimit, timeLimit, displayLimit);
+
+        opt.cpuTime = chrono::duration<double>(chrono::system_clock::now()-start).count();
+
+        native_get_solution(inp, opt);
+        native_end();
     }
+    else
+    {
+        IloCplex cplex(model);
+        double rgPeak = rowgen_peak_memory();
+        if (rowGeneration > 0 && version != 4)
+        {
+            cout << "[** Row generation (-R) requires the polyhedral version (-v 4): ignored]" << endl;
+            rowGeneration = 0;
+        }
+        {
+            PHASE_TIMER phase("build");
+            switch(version)
+            {
+                case 1 :  // single source nominal
+                    define_SS_CFLP(inp, fType, model, cplex);
+                    break;
+                case 2 : // multi source nominal
+                    define_MS_CFLP(inp, fType, model, cplex);
+                    break;
+                case 3 : // multi source ellipsoidal
+                    define_SOCP_CFLP(inp, fType, model, cplex);
+                    break;
+                case 4 : // robust polyhedral uncertainty set (both SS and MS)
+                    if (rowGeneration > 0)
+                        rowgen_define_CFLP(inp, model, cplex, support);
+                    else
+                        define_POLY_CFLP(inp, fType, model, cplex, support);
+                    break;
+                default :
+                    cout << "ERROR : Version type not defined.\n" << endl;
+                    exit(123);
+            }
+        }
+        printBuildInfo(start);
+        if (heuristicMode == 1 && heurValue < 0)
+            heuristicStart(inp);
+        addMIPStarts(cplex, inp);
+
+        if (bendersMode > 0 && bendersCompare == 1)
+            compareBenders(cplex, inp);
+        else if (linkingMode == 3)
+            compareLinking(cplex, inp);
+        else
+        {
+            if (bendersMode > 0)
+                define_benders(cplex, inp);
+            linking_use(cplex, inp);
+
+            if (scalingThreads > 0)
+                scaleCplexThreads(&cplex, inp);
+            else if (candidateK > 0)
+                solveCandidateProblem(model, cplex, inp);
+            else
+                solveCplexProblem(model, cplex, inp, solLimit, timeLimit, displayLimit);
+        }
+
+        opt.cpuTime = chrono::duration<double>(chrono::system_clock::now()-start).count();
 
-    // define_benders(model, cplex, inp);
+        getCplexSol(inp, cplex, opt);
+        candidate.clear(); // later models (e.g., -c 2) are dense
+        if (rowGeneration > 0)
+            rowgen_compare(inp, opt, start, rgPeak, rowGeneration == 2);
+    }
+
+    if (compactBox == 2 && compactBuilt)
+        verifyCompactModel(inp, opt);
 
-    solveCplexProblem(model, cplex, inp, solLimit, timeLimit, displayLimit);
+    if (heuristicMode == 1 && heurValue >= 0)
+        cout << "[** Heuristic :: z = " << setprecision(15) << heurValue << " in " 
+             << setprecision(4) << heurTime << " s; " << setprecision(4)
+             << 100.0*(heurValue - opt.zStar)/max(EPSI, fabs(opt.zStar)) 
+             << "% above the final MIP value]" << setprecision(6) << endl;
 
-    opt.cpuTime = chrono::duration_cast<chrono::seconds>(chrono::system_clock::now()-start).count();
+    if (reduced) // back to the original facilities
+    {
+        preprocess_expand(full, keep, opt);
+        inp = full;
+    }
 
-    getCplexSol(inp, cplex, opt);
+    writeSolution(inp, opt);
     printSolution(_FILENAME, inp, opt, true, 1);
 
 
+    waitExport();
+    phase_trace(_TRACENAME);
     env.end();
     return 0;
 }
@@ -299,20 +618,59 @@ int main(int argc, char *argv[])
 /************************ main program ******************************/
 
 /****************** FUNCTIONS DEFINITION ***************************/
+/// Print the time spent and the memory used to build the model
+/** Peak memory is the maximum resident set size of the process so far. */
+void printBuildInfo(chrono::system_clock::time_point start)
+{
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    cout << "[** Model built in " << setprecision(6)
+         << chrono::duration<double>(chrono::system_clock::now()-start).count()
+         << " s; peak memory " << usage.ru_maxrss/1024.0 << " MB, estimated "
+         << modelEstimate << " MB (" << (builder == 1 ? "native" : "Concert") << " builder)]"
+         << endl;
+}
+
+/// Store the allocations (fac[k], cus[k], val[k]), in any order, in sol (sparse format)
+void solution_set_x(INSTANCE & inp, SOLUTION & sol, vector<int> & fac, vector<int> & cus,
+                    vector<double> & val)
+{
+    sol.xBeg.assign(inp.nC + 1, 0);
+    for (unsigned k = 0; k < cus.size(); k++)
+        sol.xBeg[cus[k] + 1]++;
+    for (int j = 0; j < inp.nC; j++)
+        sol.xBeg[j + 1] += sol.xBeg[j];
+
+    vector<int> pos(sol.xBeg.begin(), sol.xBeg.end() - 1);
+    sol.xFac.resize(cus.size());
+    sol.xVal.resize(cus.size());
+    for (unsigned k = 0; k < cus.size(); k++)
+    {
+        sol.xFac[pos[cus[k]]]   = fac[k];
+        sol.xVal[pos[cus[k]]++] = val[k];
+    }
+}
+
 /// Get and store cplex solution in data structure opt
-void getCplexSol(INSTANCE inp, IloCplex cplex, SOLUTION & opt)
+/**
+ * Values are read with one call for \f$y\f$ and one call per open
+ * facility for \f$x\f$ (a closed facility serves no customer), and only
+ * the nonzero allocations are stored.
+ */
+void getCplexSol(INSTANCE & inp, IloCplex cplex, SOLUTION & opt)
 {
+    PHASE_TIMER phase("extract");
     opt.nOpen = 0;
-    opt.ySol = new int[inp.nF];
-    opt.xSol = new double*[inp.nF];
-    for (int i = 0; i < inp.nF; i++)
-        opt.xSol[i] = new double[inp.nC];
+    if (opt.ySol == NULL) // the same structure is reused by a parameter sweep
+        opt.ySol = new int[inp.nF];
 
     opt.zStar = cplex.getObjValue();
     opt.zStatus = cplex.getStatus();
 
+    IloNumArray yVal(env);
+    cplex.getValues(yVal, y_ilo);
     for (int i = 0; i < inp.nF; i++)
-        if (cplex.getValue(y_ilo[i]) >= 1.0-EPSI)
+        if (yVal[i] >= 1.0-EPSI)
         {
             opt.ySol[i] = 1;
             opt.nOpen++;
@@ -320,10 +678,61 @@ void getCplexSol(INSTANCE inp, IloCplex cplex, SOLUTION & opt)
         else
             opt.ySol[i] = 0;
 
+    vector<int>    fac, cus;
+    vector<double> val;
+    IloNumArray    xVal(env);
     for (int i = 0; i < inp.nF; i++)
+    {
+        if (yVal[i] <= EPSI)
+            continue;
+        if (candidate.empty())
+            cplex.getValues(xVal, x_ilo[i]);
         for (int j = 0; j < inp.nC; j++)
-            opt.xSol[i][j] = cplex.getValue(x_ilo[i][j]);
+        {
+            if (!isCandidate(inp, i, j))
+                continue;
+            double xij = candidate.empty() ? xVal[j] : cplex.getValue(x_ilo[i][j]);
+            if (xij > 0.0)
+            {
+                fac.push_back(i);
+                cus.push_back(j);
+                val.push_back(xij);
+            }
+        }
+    }
+    solution_set_x(inp, opt, fac, cus, val);
+    xVal.end();
+    yVal.end();
+}
+
+/// Write the result row (csv format) of the solution stored in opt
+void writeResultRow(ostream & fWriter, INSTANCE & inp, SOLUTION & opt)
+{
+    fWriter << _FILENAME << ";"
+    << _Omega << ";"
+    << _epsilon << ";"
+    << _delta << ";"
+    << _gamma << ";"
+    << L << ";"
+    << fType << ";"
+    << timeLimit << ";"
+    << version << ";"
+    << support << ";"
+    << readFromDisk << ";"
+    << inp.nF << ";" 
+    << inp.nC << ";" 
+    << setprecision(15) << opt.zStar << ";" 
+    << opt.zStatus << ";"
+    << opt.nOpen << ";"
+    << opt.cpuTime << ";";
+    phase_row(fWriter); // time and memory of the phases (see phases.cpp)
+    fWriter << endl;
+}
 
+/// Write the solution stored in opt to disk (folder "solutions")
+void writeSolution(INSTANCE & inp, SOLUTION & opt)
+{
+    PHASE_TIMER phase("write");
     switch(version)
     {
         case 1 :  // single source nominal
@@ -352,52 +761,375 @@ void getCplexSol(INSTANCE inp, IloCplex cplex, SOLUTION & opt)
     obj << _epsilon << "-" <<  _delta << "-" << _gamma << "-" << L;
     string filename = "solutions" + s1 + "-" + versionType + "-" + obj.str();
 
-    ofstream fWriter(filename, ios::out);
+    // the result row and the status go through iostream (printed by Concert)
+    ostringstream row, status;
+    writeResultRow(row, inp, opt);
+    status << opt.zStatus;
+
+    WRITER fWriter(filename);
+    fWriter << row.str();
+    fWriter << inp.nF << ' ' << inp.nC << '\n';
+    fWriter << opt.zStar << '\n';
+    fWriter << status.str() << '\n';
+    fWriter << opt.nOpen << '\n';
+    for (int i = 0; i < inp.nF; i++)
+        if (opt.ySol[i] == 1)
+            fWriter << ' ' << i;
+    fWriter << '\n';
+    for (int j = 0; j < inp.nC; j++) // only the nonzero allocations (see SOLUTION)
+        for (int k = opt.xBeg[j]; k < opt.xBeg[j+1]; k++)
+            fWriter << opt.xFac[k] << ' ' << j << ' ' << opt.xVal[k] << '\n';
+    fWriter.close();
+    cout << "Solution written to disk. ('" << filename <<"')" << endl;
+}
 
-/// Adding a new line, for the csv format - begin
 
+/// Read a solution written by writeSolution() (used as MIP start, flag -m)
+/**
+ * Only the open facilities and the allocation matrix are read. The file
+ * must refer to an instance with the same number of facilities and
+ * customers, and the indices of the facilities and customers are checked.
+ * Returns false if the file cannot be used.
+ */
+bool readSolution(char * _SOLNAME, INSTANCE & inp, SOLUTION & sol)
+{
+    ifstream fReader(_SOLNAME, ios::in);
+    if (!fReader)
+    {
+        cout << "Cannot open file '" << _SOLNAME << "'." << endl;
+        return false;
+    }
+    string line;
+    getline(fReader, line); // result row (see writeResultRow())
 
+    int nF, nC;
+    string zStatus;
+    fReader >> nF >> nC >> sol.zStar >> zStatus >> sol.nOpen;
+    if (!fReader || nF != inp.nF || nC != inp.nC || sol.nOpen < 0 || sol.nOpen > nF)
+    {
+        cout << "Solution file '" << _SOLNAME << "' does not match the instance." << endl;
+        return false;
+    }
 
-    fWriter << _FILENAME << ";"
-    << _Omega << ";"
-    << _epsilon << ";"
-    << _delta << ";"
-    << _gamma << ";"
-    << L << ";"
-    << fType << ";"
-    << timeLimit << ";"
-    << version << ";"
-    << support << ";"
-    << readFromDisk << ";"
-    << inp.nF << ";" 
-    << inp.nC << ";" 
-    << setprecision(15) << opt.zStar << ";" 
-    << opt.zStatus << ";"
-    << opt.nOpen << ";"
-    << opt.cpuTime << ";"
-    << endl;
+    vector<int> open(sol.nOpen);
+    for (int k = 0; k < sol.nOpen; k++)
+    {
+        fReader >> open[k];
+        if (!fReader || open[k] < 0 || open[k] >= inp.nF)
+        {
+            cout << "Solution file '" << _SOLNAME << "': bad open facility." << endl;
+            return false;
+        }
+    }
+    vector<int>    fac, cus;
+    vector<double> val;
+    int i, j;
+    double a;
+    while (fReader >> i >> j >> a)
+    {
+        if (i < 0 || i >= inp.nF || j < 0 || j >= inp.nC)
+        {
+            cout << "Solution file '" << _SOLNAME << "': allocation " << i << " " << j
+                 << " out of range." << endl;
+            return false;
+        }
+        fac.push_back(i);
+        cus.push_back(j);
+        val.push_back(a);
+    }
+    fReader.close();
+    sol.ySol = new int[inp.nF]();
+    for (int k = 0; k < sol.nOpen; k++)
+        sol.ySol[open[k]] = 1;
+    solution_set_x(inp, sol, fac, cus, val);
+
+    return true;
+}
+
+/// Solve the nominal (multi-source) model, to be used as MIP start (flag -n)
+/**
+ * The nominal model is defined and solved with its own IloModel and
+ * IloCplex objects. Since define_MS_CFLP() sets the global variables 
+ * `y_ilo` and `x_ilo`, this must be done before the robust model is defined.
+ */
+bool solveNominalStart(INSTANCE & inp, SOLUTION & sol)
+{
+    auto start = chrono::system_clock::now();
+    IloModel nomModel(env, "nominal");
+    IloCplex nomCplex(nomModel);
+    define_MS_CFLP(inp, fType, nomModel, nomCplex);
+
+    nomCplex.setOut(env.getNullStream());
+    nomCplex.setParam(IloCplex::Param::Threads, nThreads);
+    nomCplex.setParam(IloCplex::Param::Parallel, parallelMode);
+    nomCplex.setParam(IloCplex::ClockType, 2);
+    nomCplex.setParam(IloCplex::TiLim, timeLimit);
+    bool ok = nomCplex.solve();
+    if (ok)
+    {
+        sol.ySol = NULL;
+        getCplexSol(inp, nomCplex, sol);
+        cout << "[** Nominal start :: z = " << setprecision(15) << sol.zStar 
+             << "; " << sol.nOpen << " open facilities; " << setprecision(6)
+             << chrono::duration<double>(chrono::system_clock::now()-start).count()
+             << " s]" << endl;
+    }
+    else
+        cout << "[** Nominal start :: no solution found]" << endl;
 
-/// Adding a new line, for the csv format - end
+    nomCplex.end();
+    nomModel.end();
+    return ok;
+}
+
+/// Collect the MIP starts given with flags -m and -n
+void prepareMIPStarts(INSTANCE & inp)
+{
+    PHASE_TIMER phase("starts");
+    for (int k = 0; k < (int) _STARTNAMES.size(); k++)
+    {
+        SOLUTION sol;
+        if (readSolution(_STARTNAMES[k], inp, sol))
+        {
+            starts.push_back(sol);
+            startNames.push_back(_STARTNAMES[k]);
+        }
+    }
+
+    if (nominalStart == 1)
+    {
+        if (version <= 2)
+            cout << "[** Nominal start ignored: the model is already nominal]" << endl;
+        else
+        {
+            SOLUTION sol;
+            if (solveNominalStart(inp, sol))
+            {
+                starts.push_back(sol);
+                startNames.push_back("nominal");
+            }
+        }
+    }
+}
+
+/// Worst-case load of a facility, given \f$\sum_j d_jx_{ij}\f$ and \f$\sum_j x_{ij}^2\f$
+/**
+ * For the ellipsoidal model, it is the left hand side of the capacity
+ * constraint (see define_SOCP_CFLP()). For the polyhedral model, we use the
+ * worst case over the box \f$[d_j(1-\epsilon), d_j(1+\epsilon)]\f$, which
+ * contains the budget support too (i.e., the load might be overestimated).
+ */
+double robust_load(double lin, double sq)
+{
+    switch (version)
+    {
+        case 3 :
+            return lin + _Omega*_epsilon*sqrt(sq);
+        case 4 :
+            return lin*(1.0+_epsilon);
+        default :
+            return lin;
+    }
+}
+
+/// Make a MIP start feasible w.r.t. the (robust) capacity constraints
+/**
+ * Facilities serving some customer are opened. Then, for each facility
+ * whose worst-case load (see robust_load()) exceeds its capacity, the
+ * allocations with the largest demand are moved to the cheapest open 
+ * facility which can take them. If no open facility can, the closed
+ * facility with the smallest fixed cost per unit of capacity is opened.
+ * Each allocation \f$x_{ij}\f$ is moved as a whole, so single-source
+ * solutions stay single-source. Returns the number of facilities opened.
+ */
+int repairStart(INSTANCE & inp, SOLUTION & sol)
+{
+    int nOpened = 0;
+    int nMoved  = 0;
+    vector<double> lin(inp.nF, 0.0);
+    vector<double> sq(inp.nF, 0.0);
+    vector<int>    cusOf(sol.xFac.size());      // customer of each allocation
+    vector<vector<int> > served(inp.nF);       // allocations of each facility
+    for (int j = 0; j < inp.nC; j++)
+        for (int k = sol.xBeg[j]; k < sol.xBeg[j+1]; k++)
+        {
+            int i    = sol.xFac[k];
+            cusOf[k] = j;
+            if (sol.xVal[k] <= EPSI)
+                continue;
+            served[i].push_back(k);
+            lin[i] += inp.d[j]*sol.xVal[k];
+            sq[i]  += sol.xVal[k]*sol.xVal[k];
+            if (sol.ySol[i] == 0)
+            {
+                sol.ySol[i] = 1;
+                nOpened++;
+            }
+        }
+
+    // current allocation of customer j to facility i (position in sol, -1 if none)
+    auto find = [&](int i, int j)
+    {
+        for (int k = sol.xBeg[j]; k < sol.xBeg[j+1]; k++)
+            if (sol.xFac[k] == i)
+                return k;
+        return -1;
+    };
 
-    fWriter << inp.nF << " " << inp.nC << endl;
-    fWriter << setprecision(15) << opt.zStar << endl;
-    fWriter << opt.zStatus << endl;
-    fWriter << opt.nOpen << endl;
     for (int i = 0; i < inp.nF; i++)
-        if (opt.ySol[i] == 1)
-            fWriter << " " << i;
-    fWriter << endl;
+    {
+        if (robust_load(lin[i], sq[i]) <= inp.s[i] + EPSI)
+            continue;
+
+        sort(served[i].begin(), served[i].end(), [&](int a, int b)
+             { return inp.d[cusOf[a]]*sol.xVal[a] > inp.d[cusOf[b]]*sol.xVal[b]; });
+
+        for (int t = 0; t < (int) served[i].size(); t++)
+        {
+            if (robust_load(lin[i], sq[i]) <= inp.s[i] + EPSI)
+                break;
+            int e = served[i][t];
+            int j = cusOf[e];
+            double a = sol.xVal[e];
+
+            int best = -1;
+            for (int k = 0; k < inp.nF; k++)
+            {
+                if (k == i || sol.ySol[k] == 0)
+                    continue;
+                int    f   = find(k, j);
+                double xkj = (f >= 0 ? sol.xVal[f] : 0.0);
+                if (robust_load(lin[k] + inp.d[j]*a, sq[k] + (xkj+a)*(xkj+a) - xkj*xkj) 
+                    > inp.s[k] + EPSI)
+                    continue;
+                if (best == -1 || inp.c[k][j] < inp.c[best][j])
+                    best = k;
+            }
+            if (best == -1)
+                for (int k = 0; k < inp.nF; k++)
+                {
+                    if (sol.ySol[k] == 1 || robust_load(inp.d[j]*a, a*a) > inp.s[k] + EPSI)
+                        continue;
+                    if (best == -1 || inp.f[k]/inp.s[k] < inp.f[best]/inp.s[best])
+                        best = k;
+                }
+            if (best == -1)
+                break; // cplex will try to repair it
+
+            if (sol.ySol[best] == 0)
+            {
+                sol.ySol[best] = 1;
+                nOpened++;
+            }
+            int    f   = find(best, j);
+            double xbj = (f >= 0 ? sol.xVal[f] : 0.0);
+            lin[i]    -= inp.d[j]*a;
+            sq[i]     -= a*a;
+            lin[best] += inp.d[j]*a;
+            sq[best]  += (xbj + a)*(xbj + a) - xbj*xbj;
+            if (f >= 0) // merged with the allocation to best
+            {
+                sol.xVal[f] += a;
+                sol.xVal[e]  = 0.0;
+            }
+            else        // the allocation itself moves to best
+            {
+                sol.xFac[e] = best;
+                served[best].push_back(e);
+            }
+            nMoved++;
+        }
+    }
+
+    // drop the allocations emptied by merging
+    vector<int>    fac, cus;
+    vector<double> val;
+    for (unsigned k = 0; k < sol.xFac.size(); k++)
+        if (sol.xVal[k] > 0.0)
+        {
+            fac.push_back(sol.xFac[k]);
+            cus.push_back(cusOf[k]);
+            val.push_back(sol.xVal[k]);
+        }
+    solution_set_x(inp, sol, fac, cus, val);
+
+    sol.nOpen = 0;
     for (int i = 0; i < inp.nF; i++)
+        sol.nOpen += sol.ySol[i];
+    if (nOpened > 0 || nMoved > 0)
+        cout << "[** MIP start repaired :: " << nOpened << " facilities opened, "
+             << nMoved << " allocations moved]" << endl;
+    return nOpened;
+}
+
+/// Run the heuristic and add its solution to the MIP starts (flag -H 1)
+/**
+ * The model must have been defined already, since the heuristic uses its
+ * parameters (e.g., `_epsilon`). The local search is given 10% of the
+ * time limit.
+ */
+void heuristicStart(INSTANCE & inp)
+{
+    SOLUTION sol;
+    if (heuristic_solve(inp, sol, max(1, timeLimit/10)))
+    {
+        heurValue = sol.zStar;
+        heurTime  = sol.cpuTime;
+        starts.push_back(sol);
+        startNames.push_back("heuristic");
+    }
+}
+
+/// Repair the MIP starts and give them to cplex (flags -m and -n)
+/**
+ * Only \f$y\f$ and the nonzero \f$x\f$ are given: the remaining variables
+ * (zero allocations and the variables of the robust models) are completed
+ * by cplex (effort level MIPStartRepair).
+ */
+void addMIPStarts(IloCplex & cplex, INSTANCE & inp)
+{
+    for (int k = 0; k < (int) starts.size(); k++)
+    {
+        cout << "[** MIP start '" << startNames[k] << "' :: " 
+             << starts[k].nOpen << " open facilities]" << endl;
+        repairStart(inp, starts[k]);
+
+        IloNumVarArray startVar(env);
+        IloNumArray startVal(env);
+        for (int i = 0; i < inp.nF; i++)
+        {
+            startVar.add(y_ilo[i]);
+            startVal.add(starts[k].ySol[i]);
+        }
         for (int j = 0; j < inp.nC; j++)
-            if (opt.xSol[i][j] > 0.0)
-                fWriter << i << " " << j << " " << opt.xSol[i][j] << endl;
-    fWriter.close();
-    cout << "Solution written to disk. ('" << filename <<"')" << endl;
+            for (int t = starts[k].xBeg[j]; t < starts[k].xBeg[j+1]; t++)
+                if (isCandidate(inp, starts[k].xFac[t], j))
+                {
+                    startVar.add(x_ilo[starts[k].xFac[t]][j]);
+                    startVal.add(starts[k].xVal[t]);
+                }
+        cplex.addMIPStart(startVar, startVal, IloCplex::MIPStartRepair, 
+                          startNames[k].c_str());
+        startVar.end();
+        startVal.end();
+    }
 }
 
+/// Drop the MIP starts kept by cplex and add back the starts of -m and -n
+/**
+ * After a solve, cplex keeps its incumbent as a MIP start. Used between
+ * the runs of a comparison (see compareBenders() and compareLinking()),
+ * so that every run starts from the same point.
+ */
+void resetMIPStarts(IloCplex & cplex, INSTANCE & inp)
+{
+    if (cplex.getNMIPStarts() > 0)
+        cplex.deleteMIPStarts(0, cplex.getNMIPStarts());
+    addMIPStarts(cplex, inp);
+}
 
 /// Print solution to screen (and disk, if required)
-void printSolution(char * _FILENAME, INSTANCE inp, SOLUTION opt, bool toDisk, 
+void printSolution(char * _FILENAME, INSTANCE & inp, SOLUTION & opt, bool toDisk, 
 int fullOutput)
 {
     cout << endl << "** SOLUTION **" << endl;
@@ -424,17 +1156,17 @@ int fullOutput)
         if (fullOutput >= 2)
         {
             cout << "Allocation variables :: " << endl;
-            for (int i = 0; i < inp.nF; i++)
-                for (int j = 0; j < inp.nC; j++)
-                    if (opt.xSol[i][j] >= EPSI)
-                        cout << "x(" << i << "," << j << ") = " << setprecision(3) 
-                        << opt.xSol[i][j] << endl;
+            for (int j = 0; j < inp.nC; j++)
+                for (int k = opt.xBeg[j]; k < opt.xBeg[j+1]; k++)
+                    if (opt.xVal[k] >= EPSI)
+                        cout << "x(" << opt.xFac[k] << "," << j << ") = " << setprecision(3) 
+                        << opt.xVal[k] << endl;
         }
     }
 }
 
 /// Define the Multi-source Capacitated Facility Location Model [Nominal]
-void define_MS_CFLP(INSTANCE inp, int fType, IloModel & model, IloCplex & cplex)
+void define_MS_CFLP(INSTANCE & inp, int fType, IloModel & model, IloCplex & cplex)
 {
     IloEnv env = model.getEnv();
 
@@ -461,30 +1193,39 @@ void define_MS_CFLP(INSTANCE inp, int fType, IloModel & model, IloCplex & cplex)
         }
     }
 
+    // only the candidate allocations are used (see candidates.cpp)
+    candidateModel = 2;
+    msDemand.assign(inp.d, inp.d + inp.nC);
+
     // customers demand
+    demand_ilo = IloRangeArray(env, inp.nC);
     for (int j = 0; j < inp.nC; j++)
     {
         IloExpr sum(env);
         for (int i = 0; i < inp.nF; i++)
-            sum += x_ilo[i][j];
-        model.add(sum == 1.0);
+            if (isCandidate(inp, i, j))
+                sum += x_ilo[i][j];
+        demand_ilo[j] = (sum == 1.0);
+        model.add(demand_ilo[j]);
     }
 
     // facility capacity 
+    cap_ilo = IloRangeArray(env, inp.nF);
     for (int i = 0; i < inp.nF; i++)
     {
         IloExpr sum(env);
         for (int j = 0; j < inp.nC; j++)
-            sum += x_ilo[i][j]*inp.d[j];
+            if (isCandidate(inp, i, j))
+                sum += x_ilo[i][j]*inp.d[j];
         sum -= y_ilo[i]*inp.s[i];
 
-        model.add(sum <= 0.0);
+        cap_ilo[i] = (sum <= 0.0);
+        model.add(cap_ilo[i]);
     }
 
     // thightening the model (does not seem to be beneficial)
-     for (int i = 0; i < inp.nF; i++)
-         for (int j = 0; j < inp.nC; j++)
-              model.add(x_ilo[i][j] - y_ilo[i] <= 0.0);
+    // (in the model, separated or dropped: see linking.cpp)
+    linking_rows(inp, model);
 
     // objective function
     IloExpr totCost(env);
@@ -492,14 +1233,16 @@ void define_MS_CFLP(INSTANCE inp, int fType, IloModel & model, IloCplex & cplex)
     {
         totCost += y_ilo[i]*inp.f[i];
         for (int j = 0; j < inp.nC; j++)
-            totCost += inp.d[j]*x_ilo[i][j]*inp.c[i][j];
+            if (isCandidate(inp, i, j))
+                totCost += inp.d[j]*x_ilo[i][j]*inp.c[i][j];
     }
 
-    model.add(IloMinimize(env,totCost));
+    obj_ilo = IloMinimize(env,totCost);
+    model.add(obj_ilo);
 }
 
 /// Define the Single-source Capacitated Facility Location Model [Nominal] 
-void define_SS_CFLP(INSTANCE inp, int fType, IloModel & model, IloCplex & cplex)
+void define_SS_CFLP(INSTANCE & inp, int fType, IloModel & model, IloCplex & cplex)
 {
 
     char varName[100];
@@ -547,9 +1290,8 @@ void define_SS_CFLP(INSTANCE inp, int fType, IloModel & model, IloCplex & cplex)
     }
 
     // does it tighten the formulation?
-     for (int i = 0; i < inp.nF; i++)
-          for (int j = 0; j < inp.nC; j++)
-              model.add(x_ilo[i][j] - y_ilo[i] <= 0.0); 
+    // (in the model, separated or dropped: see linking.cpp)
+    linking_rows(inp, model);
 
     // objective function
     IloExpr totCost(env);
@@ -564,7 +1306,7 @@ void define_SS_CFLP(INSTANCE inp, int fType, IloModel & model, IloCplex & cplex)
 }
 
 /// Define the Multi-source Capacitated Facility Location Model [Ellipsoidal]
-void define_SOCP_CFLP(INSTANCE inp, int fType, IloModel & model, IloCplex & cplex)
+void define_SOCP_CFLP(INSTANCE & inp, int fType, IloModel & model, IloCplex & cplex)
 {
     read_parameters_ellipsoidal();
 
@@ -635,9 +1377,8 @@ if (L_input!=-1) L = L_input;
     }
 
     // thightening the model (does not seem to be beneficial)
-     for (int i = 0; i < inp.nF; i++)
-         for (int j = 0; j < inp.nC; j++)
-              model.add(x_ilo[i][j] - y_ilo[i] <= 0.0);
+    // (in the model, separated or dropped: see linking.cpp)
+    linking_rows(inp, model);
 
 
     // objective function
@@ -666,6 +1407,13 @@ if (L_input!=-1) L = L_input;
  * and we then build the support set around the nominal values provided by the
  * instance.
  *
+ * If the support has an analytic worst case (see box_worst_case()) and
+ * `compactBox` is set (flag **-c**), the dualized model (see define_DUAL_CFLP())
+ * is not needed: the worst-case capacity and cost are obtained with the
+ * demand \f$\bar{d}_j\f$, and we build the nominal multi-source model with
+ * \f$\bar{d}\f$ instead of \f$d\f$, i.e., \f$n_F n_C\f$ variables instead of
+ * \f$n_F(n_C + r) + r + 1\f$.
+ *
  * The polyhedral uncertainty set is defined in the form:
  * \f[ W\mathbf{d} \leq \mathbf{h} \f]
  * Therefore, before we can solve the corresponding model, we need to define
@@ -717,7 +1465,7 @@ if (L_input!=-1) L = L_input;
  * a robust problem into a nomimal one (e.g., setting \f$\epsilon = 0\f$ in box
  * support.)
  */
-void define_POLY_CFLP(INSTANCE inp, int fType, IloModel & model, IloCplex & cplex,
+void define_POLY_CFLP(INSTANCE & inp, int fType, IloModel & model, IloCplex & cplex,
                       int support)
 {
 
@@ -736,6 +1484,25 @@ void define_POLY_CFLP(INSTANCE inp, int fType, IloModel & model, IloCplex & cple
             exit(123);
     }
 
+    vector<double> dMax;
+    compactBuilt = (compactBox > 0 && box_worst_case(inp, dMax));
+    if (compactBuilt)
+    {
+        cout << "[** Analytic worst case: compact model (" << inp.nR 
+             << " support rows dropped)]" << endl;
+        double * dNom = inp.d;
+        inp.d = dMax.data();
+        define_MS_CFLP(inp, fType, model, cplex);
+        inp.d = dNom;
+        return;
+    }
+
+    define_DUAL_CFLP(inp, model);
+}
+
+/// Dualized robust model, given \f$W\f$ and \f$\mathbf{h}\f$ (see define_POLY_CFLP()).
+void define_DUAL_CFLP(INSTANCE & inp, IloModel & model)
+{
     char varName[100];
     char conName[100];
     IloEnv env = model.getEnv();
@@ -786,18 +1553,25 @@ void define_POLY_CFLP(INSTANCE inp, int fType, IloModel & model, IloCplex & cple
     delta_ilo = IloNumVarArray(env, 1, 0.0, IloInfinity, ILOFLOAT);
     delta_ilo[0].setName("delta");
 
+    // only the candidate allocations are used (see candidates.cpp)
+    candidateModel = 4;
+
     // customers demand
+    demand_ilo = IloRangeArray(env, inp.nC);
     for (int j = 0; j < inp.nC; j++)
     {
         IloExpr sum(env);
         for (int i = 0; i < inp.nF; i++)
-            sum += x_ilo[i][j];
+            if (isCandidate(inp, i, j))
+                sum += x_ilo[i][j];
 //        model.add(sum == 1.0);
 	sprintf(conName, "demand.%d", (int) j);
-        model.add(IloRange(env,1.0, sum, 1.0, conName));
+        demand_ilo[j] = IloRange(env,1.0, sum, 1.0, conName);
+        model.add(demand_ilo[j]);
     }
 
     // robust capacity h*psi <= s*y
+    rob_cap_ilo = IloRangeArray(env, inp.nF);
     for (int i = 0; i < inp.nF; i++)
     {
         IloExpr sum(env);
@@ -807,13 +1581,17 @@ void define_POLY_CFLP(INSTANCE inp, int fType, IloModel & model, IloCplex & cple
         sum -= inp.s[i]*y_ilo[i];
 //        model.add(sum <= 0.0);
 	sprintf(conName, "rob_cap.%d", (int) i);
-        model.add(IloRange(env,-IloInfinity, sum, 0.0, conName));
+        rob_cap_ilo[i] = IloRange(env,-IloInfinity, sum, 0.0, conName);
+        model.add(rob_cap_ilo[i]);
 
 
     }
 
     // "robust" demand - constr. W*psi >= x
+    rob_dem_ilo = IloArray<IloRangeArray>(env, inp.nF);
     for (int i = 0; i < inp.nF; i++)
+    {
+        rob_dem_ilo[i] = IloRangeArray(env, inp.nC);
         for (int j = 0; j < inp.nC; j++)
         {
             IloExpr sum(env);
@@ -822,14 +1600,17 @@ void define_POLY_CFLP(INSTANCE inp, int fType, IloModel & model, IloCplex & cple
                 int t = inp.index[l];
                 sum += inp.W[l]*psi_ilo[i][t];
             }
-            sum -= x_ilo[i][j];
+            if (isCandidate(inp, i, j))
+                sum -= x_ilo[i][j];
 
 //            model.add(sum >= 0.0);
 	sprintf(conName, "rob_dem_constr.%d.%d", (int) i, (int) j);
-        model.add(IloRange(env,0.0, sum, IloInfinity, conName));
+        rob_dem_ilo[i][j] = IloRange(env,0.0, sum, IloInfinity, conName);
+        model.add(rob_dem_ilo[i][j]);
 
 
         }
+    }
 
 
     // "robust" objective function: h*u <= delta
@@ -840,10 +1621,14 @@ void define_POLY_CFLP(INSTANCE inp, int fType, IloModel & model, IloCplex & cple
     sum -= delta_ilo[0];
 //    model.add(sum <= 0.0);
     sprintf(conName, "rob_delta");
-    model.add(IloRange(env,-IloInfinity, sum, 0.0, conName));
+    rob_delta_ilo = IloRange(env,-IloInfinity, sum, 0.0, conName);
+    model.add(rob_delta_ilo);
 
 
     // second robust obj function: W*u >= c*x
+    // (column j of the costs is read from the customer-major copy)
+    define_customer_major(inp);
+    rob_obj_ilo = IloRangeArray(env, inp.nC);
     for (int j = 0; j < inp.nC; j++)
     {
         IloExpr sum(env);
@@ -852,19 +1637,21 @@ void define_POLY_CFLP(INSTANCE inp, int fType, IloModel & model, IloCplex & cple
             int t = inp.index[l];
             sum += inp.W[l]*u_ilo[t];
         }
+        const double * cj = inp.cT + (long)j*inp.nF;
         for (int i = 0; i < inp.nF; i++)
-            sum -= inp.c[i][j]*x_ilo[i][j];
+            if (isCandidate(inp, i, j))
+                sum -= cj[i]*x_ilo[i][j];
 
 //        model.add(sum >= 0.0);
         sprintf(conName, "rob_obj.%d",(int) j);
-        model.add(IloRange(env,0.0, sum, IloInfinity, conName));
+        rob_obj_ilo[j] = IloRange(env,0.0, sum, IloInfinity, conName);
+        model.add(rob_obj_ilo[j]);
 
     }
 
     // thightening the model (does not seem to be beneficial)
-     for (int i = 0; i < inp.nF; i++)
-         for (int j = 0; j < inp.nC; j++)
-              model.add(x_ilo[i][j] - y_ilo[i] <= 0.0);
+    // (in the model, separated or dropped: see linking.cpp)
+    linking_rows(inp, model);
 
 
     // objective function: min f*y + delta
@@ -876,15 +1663,336 @@ void define_POLY_CFLP(INSTANCE inp, int fType, IloModel & model, IloCplex & cple
     model.add(IloMinimize(env,totCost));
 }
 
+/// Update the robust polyhedral model after a change of `_epsilon` or `_delta`
+/**
+ * These parameters only change the vector \f$\mathbf{h}\f$, i.e., the
+ * coefficients of the \f$\psi\f$ variables in the robust capacity rows and of
+ * the \f$u\f$ variables in the robust objective row. Thus, instead of building
+ * the model again, we recompute \f$\mathbf{h}\f$ (see update_support_rhs())
+ * and change these coefficients in place, one row at a time.
+ */
+void update_POLY_CFLP(INSTANCE & inp)
+{
+    update_support_rhs(inp);
+
+    IloNumArray hArr(env, inp.nR);
+    for (int t = 0; t < inp.nR; t++)
+        hArr[t] = inp.h[t];
+
+    for (int i = 0; i < inp.nF; i++)
+        rob_cap_ilo[i].setLinearCoefs(psi_ilo[i], hArr);
+    rob_delta_ilo.setLinearCoefs(u_ilo, hArr);
+    hArr.end();
+}
+
+/// Solve a sequence of robust polyhedral models (parameter sweep, flag -w)
+/**
+ * The points of the sweep are read from the file given with **-w** (see
+ * read_sweep_points()). Everything is done in the same process, so the
+ * instance is read only once, and:
+ * * the model is built only for the first point, or when `_gamma` or `L`
+ *   change with the budget support (the structure of \f$W\f$ changes).
+ *   Otherwise, only the coefficients depending on \f$\mathbf{h}\f$ are
+ *   updated (see update_POLY_CFLP());
+ * * the solution of the previous point (\f$y\f$ and \f$x\f$) is given to
+ *   cplex as a MIP start, which cplex repairs if it is no longer feasible.
+ *
+ * For each point, the solution is written as usual (see writeSolution())
+ * and one result row is appended to the file 
+ * "sweep/<instance>-v<version>-u<support>.csv".
+ */
+void sweepCplexProblem(INSTANCE & inp)
+{
+    if (version != 4)
+    {
+        cout << "ERROR : The parameter sweep (-w) requires the polyhedral version (-v 4).\n" << endl;
+        exit(123);
+    }
+    if (builder != 0)
+        cout << "[** The parameter sweep uses the Concert builder]" << endl;
+    if (compactBox != 0)
+    {
+        // the coefficients depending on h are updated in place
+        cout << "[** The parameter sweep uses the dualized model]" << endl;
+        compactBox = 0;
+    }
+
+    vector<double> eps, del, gam;
+    vector<int>    ell;
+    int nPoints = read_sweep_points(_SWEEPNAME, eps, del, gam, ell);
+
+    string  s1      = string(_FILENAME);
+    s1              = s1.substr(s1.find_last_of("\\/"), 100);
+    ostringstream obj;
+    obj << "-v" << version << "-u" << support;
+    string filename = "sweep" + s1 + obj.str() + ".csv";
+    ofstream fWriter(filename, ios::out);
+
+    IloCplex cplex(env);
+    vector<double> yStart;
+    SOLUTION prev;   // allocations of the previous point
+    for (int k = 0; k < nPoints; k++)
+    {
+        bool rebuild = (k == 0) || 
+                       (support == 2 && (gam[k] != gam[k-1] || ell[k] != ell[k-1]));
+        cout << endl << "[** Sweep point " << k+1 << "/" << nPoints << " :: _epsilon = " 
+             << eps[k] << "; _delta = " << del[k] << "; _gamma = " << gam[k] 
+             << "; L = " << ell[k] << (rebuild ? " (new model)" : " (update)") 
+             << "]" << endl;
+
+        auto start = chrono::system_clock::now();
+        _epsilon_input = eps[k];
+        _delta_input   = del[k];
+        _gamma_input   = gam[k];
+        L_input        = ell[k];
+        {
+            PHASE_TIMER phase("build");
+            if (rebuild)
+            {
+                if (k > 0)
+                {
+                    model.end();
+                    model = IloModel(env, "cflp");
+                }
+                define_POLY_CFLP(inp, fType, model, cplex, support);
+                cplex.extract(model);
+            }
+            else
+            {
+                _epsilon = eps[k];
+                _delta   = del[k];
+                update_POLY_CFLP(inp);
+            }
+        }
+        printBuildInfo(start);
+
+        if (k == 0)
+            addMIPStarts(cplex, inp);
+
+        // previous solution as MIP start
+        if (!yStart.empty())
+        {
+            IloNumVarArray startVar(env);
+            IloNumArray startVal(env);
+            for (int i = 0; i < inp.nF; i++)
+            {
+                startVar.add(y_ilo[i]);
+                startVal.add(yStart[i]);
+            }
+            for (int j = 0; j < inp.nC; j++)
+                for (int t = prev.xBeg[j]; t < prev.xBeg[j+1]; t++)
+                {
+                    startVar.add(x_ilo[prev.xFac[t]][j]);
+                    startVal.add(prev.xVal[t]);
+                }
+            cplex.addMIPStart(startVar, startVal, IloCplex::MIPStartRepair);
+            startVar.end();
+            startVal.end();
+        }
+
+        if (solveCplexProblem(model, cplex, inp, solLimit, timeLimit, displayLimit) != 1)
+        {
+            cout << "[** No solution for this point]" << endl;
+            continue;
+        }
+        opt.cpuTime = chrono::duration<double>(chrono::system_clock::now()-start).count();
+
+        getCplexSol(inp, cplex, opt);
+        writeSolution(inp, opt);
+        printSolution(_FILENAME, inp, opt, true, 0);
+        writeResultRow(fWriter, inp, opt);
+        fWriter.flush();
+
+        yStart.assign(opt.ySol, opt.ySol + inp.nF);
+        prev.xBeg = opt.xBeg;
+        prev.xFac = opt.xFac;
+        prev.xVal = opt.xVal;
+    }
+
+    fWriter.close();
+    cout << "Sweep results written to disk. ('" << filename << "')" << endl;
+}
+
+/// Export the model to disk, if required (flag -x)
+/**
+ * The model is written in the format selected with **-x** (1-SAV; 2-MPS;
+ * 3-LP), always compressed with gzip, to the file given with **-X** or, by
+ * default, to:
+ * > models/<instance>-v<version>-u<support>-<epsilon>-<delta>-<gamma>-<L>.<format>.gz
+ *
+ * Each file is written once: a model solved more than once (e.g., by the
+ * comparisons of -S, -j 3 and Benders) is exported at its first solve, while
+ * each point of a sweep (-w) has its own default file name.
+ *
+ * With **-a 1** the model is written uncompressed by cplex, and it is
+ * compressed by gzip (a separate program, started with posix_spawn()) on a
+ * background thread, while the solve goes on. Cplex itself is not used
+ * outside the main thread, and the process is not forked. The threads are
+ * joined at the end of the run (see waitExport()).
+ *
+ * `cplex` is NULL when the model has been built with the native builder.
+ */
+void exportModel(IloCplex * cplex)
+{
+    static set<string> exported; // the same model may be solved more than once
+    if (exportFormat == 0)
+        return;
+
+    const char * ext[] = {"", ".sav.gz", ".mps.gz", ".lp.gz"};
+    if (exportFormat < 0 || exportFormat > 3)
+    {
+        cout << "ERROR : Export format not defined (-x option).\n" << endl;
+        exit(123);
+    }
+
+    string filename;
+    if (_EXPORTNAME != NULL)
+        filename = string(_EXPORTNAME);
+    else
+    {
+        string  s1      = string(_FILENAME);
+        s1              = s1.substr(s1.find_last_of("\\/"), 100);
+        ostringstream obj;
+        obj << "-v" << version << "-u" << support << "-" << _epsilon << "-" 
+            <<  _delta << "-" << _gamma << "-" << L;
+        filename = "models" + s1 + obj.str() + ext[exportFormat];
+    }
+    if (!exported.insert(filename).second)
+        return;
+    PHASE_TIMER phase("export");
+
+    // background compression: only for gzip file names
+    bool async = exportAsync == 1 && filename.size() > 3
+                 && filename.compare(filename.size() - 3, 3, ".gz") == 0;
+    string written = async ? filename.substr(0, filename.size() - 3) : filename;
+    if (cplex != NULL)
+        cplex->exportModel(written.c_str());
+    else
+        native_export(written.c_str());
+    if (!async)
+    {
+        cout << "[** Model exported to '" << filename << "']" << endl;
+        return;
+    }
+
+    exportThreads.push_back(thread([written]() {
+        char * argv[] = {(char *) "gzip", (char *) "-f", (char *) written.c_str(), NULL};
+        pid_t pid;
+        int   status;
+        if (posix_spawnp(&pid, "gzip", NULL, NULL, argv, environ) != 0
+            || waitpid(pid, &status, 0) != pid || !WIFEXITED(status) || WEXITSTATUS(status) != 0)
+            exportFailed++;
+    }));
+    cout << "[** Model written to '" << written << "', compressing to '" << filename
+         << "' in background]" << endl;
+}
+
+/// Solve the same model with 1, 2, 4, ... threads and report the scaling
+/**
+ * The model is solved from scratch (no advanced start) with 1, 2, 4, ... and 
+ * finally `scalingThreads` threads (flag **-S**), using the parallel mode
+ * given with **-P**. For each setting, we report the wall-clock time, the
+ * number of nodes, the final gap and objective value, the speedup w.r.t. one
+ * thread and the efficiency (speedup/threads). An efficiency well below one
+ * means that running more independent jobs side by side is a better use of
+ * the cores than a multi-threaded solve.
+ *
+ * The report is printed and written to the folder "scaling". The solution
+ * of the last setting is the one stored in opt. `cplex` is NULL when the
+ * model has been built with the native builder.
+ */
+void scaleCplexThreads(IloCplex * cplex, INSTANCE & inp)
+{
+    vector<int>    threads;
+    vector<double> wall, gap, zStar;
+    vector<long>   nodes;
+    for (int t = 1; t < scalingThreads; t *= 2)
+        threads.push_back(t);
+    threads.push_back(scalingThreads);
+
+    for (unsigned k = 0; k < threads.size(); k++)
+    {
+        nThreads = threads[k];
+        cout << "[** Scaling :: solving with " << nThreads << " thread(s)]" << endl;
+        auto start = chrono::system_clock::now();
+        long   nNodes = 0;
+        double zGap   = INFTY;
+        double z      = INFTY;
+        if (cplex != NULL)
+        {
+            cplex->setParam(IloCplex::AdvInd, 0);
+            if (solveCplexProblem(model, *cplex, inp, solLimit, timeLimit, displayLimit) == 1)
+            {
+                z      = cplex->getObjValue();
+                zGap   = cplex->getMIPRelativeGap();
+            }
+            nNodes = cplex->getNnodes();
+        }
+        else
+        {
+            native_solve(solLimit, timeLimit, displayLimit);
+            native_progress(nNodes, zGap, z);
+        }
+        wall.push_back(chrono::duration<double>(chrono::system_clock::now()-start).count());
+        nodes.push_back(nNodes);
+        gap.push_back(zGap);
+        zStar.push_back(z);
+    }
+
+    string  s1      = string(_FILENAME);
+    s1              = s1.substr(s1.find_last_of("\\/"), 100);
+    ostringstream obj;
+    obj << "-v" << version << "-u" << support << "-P" << parallelMode;
+    string filename = "scaling" + s1 + obj.str() + ".txt";
+    ofstream fWriter(filename, ios::out);
+
+    cout << endl << "** THREAD SCALING (parallel mode " << parallelMode << ") **" << endl;
+    cout << setw(8) << "threads" << setw(12) << "time" << setw(12) << "nodes" 
+         << setw(12) << "gap" << setw(20) << "z*" << setw(10) << "speedup" 
+         << setw(12) << "efficiency" << endl;
+    fWriter << "threads;time;nodes;gap;z;speedup;efficiency" << endl;
+    for (unsigned k = 0; k < threads.size(); k++)
+    {
+        double speedup = wall[0]/wall[k];
+        cout << setw(8) << threads[k] << setw(12) << setprecision(4) << wall[k] 
+             << setw(12) << nodes[k] << setw(12) << gap[k] 
+             << setw(20) << setprecision(12) << zStar[k] 
+             << setw(10) << setprecision(3) << speedup 
+             << setw(12) << speedup/threads[k] << endl;
+        fWriter << threads[k] << ";" << wall[k] << ";" << nodes[k] << ";" << gap[k] 
+                << ";" << setprecision(15) << zStar[k] << ";" << setprecision(6) 
+                << speedup << ";" << speedup/threads[k] << endl;
+    }
+    fWriter.close();
+    cout << "Scaling report written to disk. ('" << filename << "')" << endl << endl;
+}
+
+/// Wait for the background compressions of the exported models (if any) to finish.
+void waitExport()
+{
+    if (exportThreads.empty())
+        return;
+    for (thread & t : exportThreads)
+        t.join();
+    if (exportFailed == 0)
+        cout << "[** Background export completed]" << endl;
+    else
+        cout << "[** Background export FAILED (" << exportFailed << " files not compressed)]"
+             << endl;
+    exportThreads.clear();
+    exportFailed = 0;
+}
+
 /// Set cplex parameters and solve the optimization problem
-int solveCplexProblem(IloModel model, IloCplex cplex, INSTANCE inp, int solLimit, int timeLimit, int displayLimit)
+int solveCplexProblem(IloModel model, IloCplex cplex, INSTANCE & inp, int solLimit, int timeLimit, int displayLimit)
 {
     try
     {
         IloEnv env = model.getEnv();
         /* cplex.setOut(env.getNullStream()); */
 
-        cplex.setParam(IloCplex::Param::Threads, 1); // 1 --> Cpu Time; 2 --> Wall-clock 
+        cplex.setParam(IloCplex::Param::Threads, nThreads); // 0 --> all cores
+        cplex.setParam(IloCplex::Param::Parallel, parallelMode); // 1 --> deterministic; -1 --> opportunistic
         cplex.setParam(IloCplex::ClockType, 2); // 1 --> Cpu Time; 2 --> Wall-clock 
         cplex.setParam(IloCplex::ClockType, 2); // 1 --> Cpu Time; 2 --> Wall clock
         cplex.setParam(IloCplex::MIPInterval, 5000);
@@ -892,9 +2000,18 @@ int solveCplexProblem(IloModel model, IloCplex cplex, INSTANCE inp, int solLimit
         cplex.setParam(IloCplex::IntSolLim, solLimit);
         cplex.setParam(IloCplex::TiLim, timeLimit);
 
-        cplex.exportModel("cflp.lp");
+        exportModel(&cplex);
 
-        if (!cplex.solve())
+        IloCplex::Callback trajCb;
+        bool trajectory = trajectory_use(cplex, trajCb);
+        bool solved;
+        {
+            PHASE_TIMER phase("solve");
+            solved = cplex.solve();
+        }
+        if (trajectory)
+            trajectory_end(cplex, trajCb);
+        if (!solved)
         {
             env.error() << "Failed to Optimize MIP " << endl;
             throw(-1);
@@ -909,6 +2026,96 @@ int solveCplexProblem(IloModel model, IloCplex cplex, INSTANCE inp, int solLimit
 }
 
 
+/// Check whether the support has an analytic worst case, i.e., it is a box.
+/**
+ * This is the case if:
+ * * each row with a single element bounds one demand (from above if the
+ *   element is positive, from below otherwise), and each demand has an
+ *   upper bound \f$\bar{d}_j\f$ (the tightest one) not smaller than its
+ *   lower bound;
+ * * each other row has nonnegative elements and is satisfied by
+ *   \f$\bar{d}\f$ (e.g., a budget \f$b_l\f$ not smaller than
+ *   \f$\sum_{j \in B_l} \bar{d}_j\f$), i.e., it does not cut the box.
+ *
+ * Since allocations and costs are nonnegative, \f$\bar{d}\f$ is then the
+ * worst case for every capacity constraint and for the cost. For the box
+ * support, \f$\bar{d}_j = d_j(1+\epsilon)\f$. If true, \f$\bar{d}\f$ is
+ * returned in `dMax`.
+ */
+bool box_worst_case(INSTANCE & inp, vector<double> & dMax)
+{
+    vector<int> rowCount(inp.nR, 0);
+    for (int l = 0; l < inp.start[inp.nC]; l++)
+        rowCount[inp.index[l]]++;
+
+    dMax.assign(inp.nC, INFTY);
+    vector<double> dMin(inp.nC, 0.0);
+    for (int j = 0; j < inp.nC; j++)
+        for (int l = inp.start[j]; l < inp.start[j+1]; l++)
+        {
+            int t = inp.index[l];
+            if (rowCount[t] != 1)
+                continue;
+            if (inp.W[l] > 0)
+                dMax[j] = min(dMax[j], inp.h[t]/inp.W[l]);
+            else if (inp.W[l] < 0)
+                dMin[j] = max(dMin[j], inp.h[t]/inp.W[l]);
+        }
+    for (int j = 0; j < inp.nC; j++)
+        if (dMax[j] == INFTY || dMax[j] < dMin[j] - EPSI)
+            return false;
+
+    vector<double> lhs(inp.nR, 0.0);
+    for (int j = 0; j < inp.nC; j++)
+        for (int l = inp.start[j]; l < inp.start[j+1]; l++)
+        {
+            int t = inp.index[l];
+            if (rowCount[t] == 1)
+                continue;
+            if (inp.W[l] < 0)
+                return false;
+            lhs[t] += inp.W[l]*dMax[j];
+        }
+    for (int t = 0; t < inp.nR; t++)
+        if (rowCount[t] > 1 && lhs[t] > inp.h[t] + EPSI)
+            return false;
+
+    return true;
+}
+
+/// Check the compact model against the dualized one (flag -c 2)
+/**
+ * The dualized model (see define_DUAL_CFLP()) is built on the same support
+ * and solved with the same parameters, and its optimal value is compared
+ * with the one of the compact model (stored in opt).
+ */
+void verifyCompactModel(INSTANCE & inp, SOLUTION & opt)
+{
+    cout << "[** Checking the compact model against the dualized one]" << endl;
+    IloModel dualModel(env, "cflp-dual");
+    IloCplex dualCplex(dualModel);
+    define_DUAL_CFLP(inp, dualModel);
+    dualCplex.setOut(env.getNullStream());
+    dualCplex.setParam(IloCplex::Param::Threads, nThreads);
+    dualCplex.setParam(IloCplex::Param::Parallel, parallelMode);
+    dualCplex.setParam(IloCplex::ClockType, 2);
+    dualCplex.setParam(IloCplex::TiLim, timeLimit);
+
+    if (!dualCplex.solve())
+        cout << "[** Compact model check :: no solution for the dualized model]" << endl;
+    else
+    {
+        double zDual = dualCplex.getObjValue();
+        double diff  = fabs(opt.zStar - zDual)/max(1.0, fabs(zDual));
+        cout << "[** Compact model check :: z compact = " << setprecision(15) << opt.zStar
+             << "; z dualized = " << zDual << "; relative difference = " 
+             << setprecision(6) << diff 
+             << (diff <= 1.0e-4 ? " (OK)]" : " (MISMATCH)]") << endl;
+    }
+    dualCplex.end();
+    dualModel.end();
+}
+
 /// Define \f$W\f$ and \f$\mathbf{h}\f$, given the value of `_epsilon`.
 /**
  * We need to define \f$W\mathbf{d} \leq \mathbf{h}\f$, where:
@@ -960,6 +2167,7 @@ int solveCplexProblem(IloModel model, IloCplex cplex, INSTANCE inp, int solLimit
  */
 void define_box_support(INSTANCE & inp)
 {
+   PHASE_TIMER phase("support");
    read_parameters_box();
 
 if (_Omega_input!=-1) _Omega = _Omega_input;
@@ -1076,6 +2284,7 @@ if (L_input!=-1) L = L_input;
  */
 void define_budget_support(INSTANCE & inp, bool fromDisk)
 {
+    PHASE_TIMER phase("support");
 
     int    nBl     = 0;
     int  **Bl;
@@ -1221,6 +2430,32 @@ if (L_input!=-1) L = L_input;
 
 }
 
+/// Recompute \f$\mathbf{h}\f$ for the current values of `_epsilon` and `_delta`.
+/**
+ * The structure of \f$W\f$ is unchanged. The box part of \f$\mathbf{h}\f$ is
+ * defined as in define_box_support(), while the budget part (rows
+ * \f$2n, ..., 2n+L-1\f$, if any) is defined as in define_budget_support(),
+ * i.e., \f$b_l = \lfloor \delta \sum_{j \in B_l} d_j \rfloor\f$, where the sets
+ * \f$B_l\f$ are read from the columns of \f$W\f$.
+ */
+void update_support_rhs(INSTANCE & inp)
+{
+    for (int j = 0; j < inp.nC; j++)
+    {
+        inp.h[j]        = -inp.d[j]*(1.0-_epsilon);
+        inp.h[j+inp.nC] =  inp.d[j]*(1.0+_epsilon);
+    }
+
+    for (int t = 2*inp.nC; t < inp.nR; t++)
+        inp.h[t] = 0.0;
+    for (int j = 0; j < inp.nC; j++)
+        for (int l = inp.start[j]; l < inp.start[j+1]; l++)
+            if (inp.index[l] >= 2*inp.nC)
+                inp.h[inp.index[l]] += inp.d[j];
+    for (int t = 2*inp.nC; t < inp.nR; t++)
+        inp.h[t] = floor(_delta*inp.h[t]);
+}
+
 /// Save Budget Uncertainty Set Info on disk.
 /** We save the parameters and the data needed to recreate the budget instance.
  *  This is done to ensure reproducibility of a robust instance. If we decide
@@ -1287,16 +2522,47 @@ void read_instance_from_disk(double & _epsilon, double & _delta, double & _gamma
 }
 
 /// Benders decomposition algorithm
-/** We use the Benders algorithm provided by cplex, with the following
- * strategy:
- * - `IloCplex::BendersUser`
- * In reality, the default strategy `BendersFull`, in which cplex chooses how
- * to assign variables to the master, would also work.
- * 
+/** We use the Benders algorithm provided by cplex, with the strategy
+ * `IloCplex::BendersUser`, i.e., the partition of the variables is given
+ * with an annotation. By default, variables are assigned to the subproblem
+ * (value 1). The partition depends on `bendersMode` (flag **-B**):
+ * - 1 : location variables \f$y\f$ in the master;
+ * - 2 : as 1, plus the robust cost \f$\delta\f$ (polyhedral model only);
+ * - 3 : \f$y\f$ and \f$x\f$ in the master, one subproblem for the block
+ *       \f$\psi_i\f$ of each facility \f$i\f$ (subproblem \f$i+1\f$) and one
+ *       for \f$u\f$ and \f$\delta\f$ (subproblem \f$n_F+1\f$) (polyhedral 
+ *       model only). Each robust capacity row only involves \f$y_i\f$, 
+ *       \f$x_{i\cdot}\f$ and \f$\psi_i\f$, so the subproblems are independent.
+ *
+ * Benders requires continuous subproblems and linear constraints: it is
+ * not available for the single-source (-v 1) and the ellipsoidal (-v 3)
+ * models, which are then solved with branch-and-cut (the function returns
+ * false). For the multi-source model, modes 2 and 3 are the same as 1.
+ *
+ * The annotation is written to the folder "models" only if required 
+ * (flag **-A**).
  */
-void define_benders(IloModel & model, IloCplex & cplex, INSTANCE inp)
+bool define_benders(IloCplex & cplex, INSTANCE & inp)
 {
-    IloEnv env = model.getEnv();
+    if (rowGeneration > 0)
+    {
+        cout << "[** Benders not available with row generation: branch-and-cut is used]" << endl;
+        return false;
+    }
+    if (version == 1 || version == 3)
+    {
+        cout << "[** Benders not available for the " 
+             << (version == 1 ? "single-source" : "ellipsoidal") 
+             << " model: branch-and-cut is used]" << endl;
+        return false;
+    }
+    int mode = bendersMode;
+    if ((version == 2 || compactBuilt || !candidate.empty()) && mode > 1)
+    {
+        cout << "[** Benders partition " << mode << " needs the dualized polyhedral "
+             << "model: partition 1 is used]" << endl;
+        mode = 1;
+    }
 
     // by default, variables are assigned to the subproblem (value 1)
     IloCplex::LongAnnotation benders = cplex.newLongAnnotation("cpxBendersPartition",1);
@@ -1309,8 +2575,99 @@ void define_benders(IloModel & model, IloCplex & cplex, INSTANCE inp)
     for (int i = 0; i < inp.nF; i++)
         cplex.setAnnotation(benders, y_ilo[i], 0);
 
+    switch (mode)
+    {
+        case 1 :
+            break;
+        case 2 : 
+            cplex.setAnnotation(benders, delta_ilo[0], 0);
+            break;
+        case 3 :
+            for (int i = 0; i < inp.nF; i++)
+            {
+                cplex.setAnnotation(benders, x_ilo[i], 0);
+                cplex.setAnnotation(benders, psi_ilo[i], i+1);
+            }
+            cplex.setAnnotation(benders, u_ilo, inp.nF+1);
+            cplex.setAnnotation(benders, delta_ilo[0], inp.nF+1);
+            break;
+        default :
+            cout << "ERROR : Benders partition not defined.\n" << endl;
+            exit(123);
+    }
+
     // save annotation to disk
-    cplex.writeBendersAnnotation("benders.ann");
+    if (bendersAnnotation == 1)
+    {
+        string  s1      = string(_FILENAME);
+        s1              = s1.substr(s1.find_last_of("\\/"), 100);
+        ostringstream obj;
+        obj << "-v" << version << "-u" << support << "-B" << mode;
+        string filename = "models" + s1 + obj.str() + ".ann";
+        cplex.writeBendersAnnotation(filename.c_str());
+        cout << "[** Benders annotation written to '" << filename << "']" << endl;
+    }
+
+    return true;
+}
+
+/// Solve the model with branch-and-cut and with Benders, and compare them
+/**
+ * Both runs start from scratch (no advanced start, apart from the MIP
+ * starts, if any, which are reset before the Benders run, see
+ * resetMIPStarts()), with the same parameters. We report wall-clock time,
+ * number of nodes, final gap and objective value of each method. The
+ * report is printed and written to the folder "benders". The solution of
+ * the Benders run is the one stored in opt.
+ */
+void compareBenders(IloCplex & cplex, INSTANCE & inp)
+{
+    string method[2] = {"branch-and-cut", "benders"};
+    double wall[2], gap[2], zStar[2];
+    long   nodes[2];
+    for (int k = 0; k < 2; k++)
+    {
+        if (k == 1 && !define_benders(cplex, inp))
+        {
+            wall[k] = wall[0]; gap[k] = gap[0]; zStar[k] = zStar[0]; nodes[k] = nodes[0];
+            break;
+        }
+        cout << "[** Benders comparison :: solving with " << method[k] << "]" << endl;
+        if (k > 0) // not from the incumbent of branch-and-cut
+            resetMIPStarts(cplex, inp);
+        cplex.setParam(IloCplex::AdvInd, starts.empty() ? 0 : 1);
+        auto start = chrono::system_clock::now();
+        gap[k]   = INFTY;
+        zStar[k] = INFTY;
+        if (solveCplexProblem(model, cplex, inp, solLimit, timeLimit, displayLimit) == 1)
+        {
+            zStar[k] = cplex.getObjValue();
+            gap[k]   = cplex.getMIPRelativeGap();
+        }
+        nodes[k] = cplex.getNnodes();
+        wall[k]  = chrono::duration<double>(chrono::system_clock::now()-start).count();
+    }
 
+    string  s1      = string(_FILENAME);
+    s1              = s1.substr(s1.find_last_of("\\/"), 100);
+    ostringstream obj;
+    obj << "-v" << version << "-u" << support << "-B" << bendersMode;
+    string filename = "benders" + s1 + obj.str() + ".txt";
+    ofstream fWriter(filename, ios::out);
 
+    cout << endl << "** BENDERS vs BRANCH-AND-CUT (partition " << bendersMode << ") **" << endl;
+    cout << setw(16) << "method" << setw(12) << "time" << setw(12) << "nodes" 
+         << setw(12) << "gap" << setw(20) << "z*" << endl;
+    fWriter << "method;time;nodes;gap;z" << endl;
+    for (int k = 0; k < 2; k++)
+    {
+        cout << setw(16) << method[k] << setw(12) << setprecision(4) << wall[k] 
+             << setw(12) << nodes[k] << setw(12) << gap[k] 
+             << setw(20) << setprecision(12) << zStar[k] << endl;
+        fWriter << method[k] << ";" << wall[k] << ";" << nodes[k] << ";" << gap[k] 
+                << ";" << setprecision(15) << zStar[k] << setprecision(6) << endl;
+    }
+    cout << "[** Faster method :: " << method[wall[1] < wall[0] ? 1 : 0] << "]" << endl;
+    fWriter.close();
+    cout << "Benders report written to disk. ('" << filename << "')" << endl << endl;
 }
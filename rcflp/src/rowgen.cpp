@@ -0,0 +1,409 @@
+/***************************************************************************
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+/*! \file rowgen.cpp
+  \brief Row generation solver for the robust polyhedral model.
+
+ * This is an alternative to the dualized model of define_POLY_CFLP(),
+ * activated with the command line flag **-R**. Instead of dualizing the
+ * inner problems, which adds \f$n_F r + r + 1\f$ variables and
+ * \f$n_F n_C + n_C + n_F\f$ rows, we solve a master problem with the variables
+ * \f$y\f$, \f$x\f$ and \f$\eta\f$ (robust transportation cost):
+ * \f[
+ *  \min \sum_i f_iy_i + \eta
+ * \f]
+ * in which capacity and cost are only imposed for a small set of demand
+ * scenarios (initially, the scenario of the support with the largest total
+ * demand, given by the oracle: the nominal demand is not in the budget
+ * support when \f$\delta < 1\f$, and its rows could cut off the robust
+ * optimum). Whenever cplex finds an integer solution, a lazy constraint
+ * callback (see RowGenCallback) computes the worst-case demand over the
+ * support \f$\{ \mathbf{d} \geq 0 : W\mathbf{d} \leq \mathbf{h}\}\f$:
+ * * for the capacity of each open facility \f$i\f$, i.e.,
+ *   \f$\max \sum_j x_{ij}d_j\f$;
+ * * for the cost, i.e., \f$\max \sum_j (\sum_i c_{ij}x_{ij})d_j\f$;
+ *
+ * and adds the capacity row \f$\sum_j \hat{d}_jx_{ij} \leq s_iy_i\f$ or the
+ * cost row \f$\eta \geq \sum_j \hat{d}_j\sum_i c_{ij}x_{ij}\f$ of each
+ * violated scenario \f$\hat{\mathbf{d}}\f$.
+ *
+ * The worst case is found by an LP over the support (see ORACLE), solved
+ * with its own environment, or in closed form if the support has an analytic
+ * worst case (see box_worst_case()). With **-R 2**, the dualized model is
+ * solved too, and time and memory of the two approaches are reported (see
+ * rowgen_compare()).
+ */
+
+#include <ilcplex/ilocplex.h>
+ILOSTLBEGIN
+
+#include <iostream>
+#include <iomanip>
+#include <cstdlib>
+#include <vector>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <sys/resource.h>
+
+using namespace std;
+
+
+struct INSTANCE { /// See same data structure define in rcflp.cpp
+    int nF;
+    int nC;
+    double  *f;
+    double  *s;
+    double  *d;
+    double **c;
+    double  *cT;   // costs in customer-major format (cT[j*nF+i])
+    double   totS;
+    double   totD;
+
+    int nR;        // number of constraints polyhedron uncertainty set
+    double  *h;    // rhs of polyhedron definining support
+    int     *W;    // matrix W in column major format
+    int *index;    // index of column major format for w
+    int *start;    // starting position for elements of column j
+};
+
+struct SOLUTION { /// See same data structure define in rcflp.cpp
+    int nOpen;
+    int  *ySol;
+    vector<int>    xBeg;  // customer-major sparse allocations (see rcflp.cpp)
+    vector<int>    xFac;
+    vector<double> xVal;
+    double zStar;
+    IloAlgorithm::Status zStatus;
+    IloNum startTime;
+    IloNum cpuTime;
+};
+
+typedef IloArray <IloNumVarArray> TwoD;
+extern TwoD x_ilo;
+extern IloNumVarArray y_ilo;
+extern IloEnv env;
+extern int nThreads;
+extern int parallelMode;
+extern int timeLimit;
+
+const double EPSI = 0.00001;
+
+void define_box_support(INSTANCE & inp);
+void define_budget_support(INSTANCE & inp, bool fromDisk);
+void define_DUAL_CFLP(INSTANCE & inp, IloModel & model);
+bool box_worst_case(INSTANCE & inp, vector<double> & dMax);
+void linking_rows(INSTANCE & inp, IloModel & model);
+
+
+/// Worst-case demand over the support \f$W\mathbf{d} \leq \mathbf{h}\f$, \f$\mathbf{d} \geq 0\f$
+/**
+ * The LP has its own environment, so that it can be solved from inside the
+ * callbacks of the master problem. Calls are serialized with a mutex, since
+ * the callbacks can be invoked by more than one thread.
+ */
+struct ORACLE {
+    IloEnv         oEnv;
+    IloModel       oModel;
+    IloNumVarArray d;
+    IloObjective   obj;
+    IloCplex       oCplex;
+    bool           closedForm; //!< true if the support is a box (dMax is the worst case)
+    vector<double> dMax;
+    long           nCalls;
+    double         time;       //!< total time spent in the oracle (seconds)
+    mutex          lock;
+
+    void build(INSTANCE & inp)
+    {
+        nCalls     = 0;
+        time       = 0.0;
+        closedForm = box_worst_case(inp, dMax);
+        if (closedForm)
+            return;
+
+        oModel = IloModel(oEnv);
+        d      = IloNumVarArray(oEnv, inp.nC, 0.0, IloInfinity, ILOFLOAT);
+        IloRangeArray rows(oEnv, inp.nR);
+        for (int t = 0; t < inp.nR; t++)
+            rows[t] = IloRange(oEnv, -IloInfinity, inp.h[t]);
+        for (int j = 0; j < inp.nC; j++)
+            for (int l = inp.start[j]; l < inp.start[j+1]; l++)
+                rows[inp.index[l]].setLinearCoef(d[j], inp.W[l]);
+        for (int t = 0; t < inp.nR; t++)
+            oModel.add(rows[t]);
+        obj = IloMaximize(oEnv);
+        oModel.add(obj);
+
+        oCplex = IloCplex(oModel);
+        oCplex.setOut(oEnv.getNullStream());
+        oCplex.setParam(IloCplex::Param::Threads, 1);
+    }
+
+    /// Maximize \f$\sum_j coef_jd_j\f$; the maximizer goes in dStar.
+    double worst(INSTANCE & inp, IloNumArray & coef, vector<double> & dStar)
+    {
+        lock_guard<mutex> guard(lock);
+        auto start = chrono::system_clock::now();
+        nCalls++;
+
+        double value = 0.0;
+        if (closedForm)
+        {
+            dStar = dMax;
+            for (int j = 0; j < inp.nC; j++)
+                value += coef[j]*dMax[j];
+        }
+        else
+        {
+            obj.setLinearCoefs(d, coef);
+            oCplex.solve();
+            value = oCplex.getObjValue();
+            IloNumArray dVal(oEnv);
+            oCplex.getValues(dVal, d);
+            dStar.assign(inp.nC, 0.0);
+            for (int j = 0; j < inp.nC; j++)
+                dStar[j] = dVal[j];
+            dVal.end();
+        }
+
+        time += chrono::duration<double>(chrono::system_clock::now()-start).count();
+        return value;
+    }
+
+    void end()
+    {
+        oEnv.end();
+    }
+};
+
+ORACLE * oracle = NULL;   //!< Worst-case demand oracle (built with the master)
+IloNumVar eta_ilo;        //!< Robust transportation cost (master problem)
+atomic<long> rowgenCapCuts(0);  //!< Number of capacity rows added by the callback
+atomic<long> rowgenCostCuts(0); //!< Number of cost rows added by the callback
+
+
+/// Lazy constraint callback: add the rows of the violated worst-case scenarios
+ILOLAZYCONSTRAINTCALLBACK1(RowGenCallback, INSTANCE *, pInp)
+{
+    INSTANCE & inp = *pInp;
+    IloEnv cbEnv = getEnv();
+    vector<double> dStar;
+
+    IloNumArray coef(cbEnv, inp.nC);
+    IloNumArray cost(cbEnv, inp.nC);
+    for (int j = 0; j < inp.nC; j++)
+        cost[j] = 0.0;
+
+    IloNumArray xVal(cbEnv);
+    for (int i = 0; i < inp.nF; i++)
+    {
+        getValues(xVal, x_ilo[i]);
+        for (int j = 0; j < inp.nC; j++)
+            cost[j] += inp.c[i][j]*xVal[j];
+
+        double yVal = getValue(y_ilo[i]);
+        if (yVal < 0.5)
+            continue;
+
+        // robust capacity of facility i
+        for (int j = 0; j < inp.nC; j++)
+            coef[j] = xVal[j];
+        double load = oracle->worst(inp, coef, dStar);
+        if (load > inp.s[i]*yVal + EPSI*max(1.0, inp.s[i]))
+        {
+            IloExpr sum(cbEnv);
+            for (int j = 0; j < inp.nC; j++)
+                if (dStar[j] > 0.0)
+                    sum += dStar[j]*x_ilo[i][j];
+            sum -= inp.s[i]*y_ilo[i];
+            add(sum <= 0.0).end();
+            sum.end();
+            rowgenCapCuts++;
+        }
+    }
+
+    // robust transportation cost
+    double worstCost = oracle->worst(inp, cost, dStar);
+    double etaVal    = getValue(eta_ilo);
+    if (worstCost > etaVal + EPSI*max(1.0, worstCost))
+    {
+        IloExpr sum(cbEnv);
+        for (int j = 0; j < inp.nC; j++)
+            if (dStar[j] > 0.0)
+                for (int i = 0; i < inp.nF; i++)
+                    sum += dStar[j]*inp.c[i][j]*x_ilo[i][j];
+        sum -= eta_ilo;
+        add(sum <= 0.0).end();
+        sum.end();
+        rowgenCostCuts++;
+    }
+
+    xVal.end();
+    coef.end();
+    cost.end();
+}
+
+
+/// Define the master problem of the row generation solver (flag -R)
+/**
+ * The support is defined as in define_POLY_CFLP(), and the oracle is
+ * built on it. The master contains demand, linking and seed scenario rows;
+ * the callback RowGenCallback is attached to `cplex`.
+ */
+void rowgen_define_CFLP(INSTANCE & inp, IloModel & model, IloCplex & cplex, int support)
+{
+    switch (support)
+    {
+        case 1 :
+            define_box_support(inp);
+            break;
+        case 2 :
+            define_budget_support(inp, false);
+            break;
+        default :
+            cout << "ERROR : Support type not defined.\n" << endl;
+            exit(123);
+    }
+    oracle = new ORACLE();
+    oracle->build(inp);
+
+    char varName[100];
+    IloEnv env = model.getEnv();
+
+    y_ilo = IloNumVarArray(env, inp.nF, 0, 1, ILOINT);
+    x_ilo = TwoD(env, inp.nF);
+    for (int i = 0; i < inp.nF; i++)
+        x_ilo[i] = IloNumVarArray(env, inp.nC, 0.0, 1.0, ILOFLOAT); // MS
+    eta_ilo = IloNumVar(env, 0.0, IloInfinity, ILOFLOAT, "eta");
+    for (int i = 0; i < inp.nF; i++)
+    {
+        sprintf(varName, "y.%d", (int)i);
+        y_ilo[i].setName(varName);
+        for (int j = 0; j < inp.nC; j++)
+        {
+            sprintf(varName, "x.%d.%d", (int)i, (int) j);
+            x_ilo[i][j].setName(varName);
+        }
+    }
+
+    // customers demand
+    for (int j = 0; j < inp.nC; j++)
+    {
+        IloExpr sum(env);
+        for (int i = 0; i < inp.nF; i++)
+            sum += x_ilo[i][j];
+        model.add(sum == 1.0);
+    }
+
+    // capacity and cost for the scenario of largest total demand: it belongs to
+    // the support, unlike the nominal demand (b_l < sum of d_j over B_l when delta < 1)
+    vector<double> dSeed;
+    IloNumArray ones(env, inp.nC);
+    for (int j = 0; j < inp.nC; j++)
+        ones[j] = 1.0;
+    oracle->worst(inp, ones, dSeed);
+    ones.end();
+    for (int i = 0; i < inp.nF; i++)
+    {
+        IloExpr sum(env);
+        for (int j = 0; j < inp.nC; j++)
+            sum += x_ilo[i][j]*dSeed[j];
+        sum -= y_ilo[i]*inp.s[i];
+        model.add(sum <= 0.0);
+    }
+    IloExpr seedCost(env);
+    for (int i = 0; i < inp.nF; i++)
+        for (int j = 0; j < inp.nC; j++)
+            seedCost += x_ilo[i][j]*inp.c[i][j]*dSeed[j];
+    model.add(seedCost - eta_ilo <= 0.0);
+
+    linking_rows(inp, model);
+
+    // objective function: min f*y + eta
+    IloExpr totCost(env);
+    for (int i = 0; i < inp.nF; i++)
+        totCost += y_ilo[i]*inp.f[i];
+    totCost += eta_ilo;
+    model.add(IloMinimize(env,totCost));
+
+    cplex.use(RowGenCallback(env, &inp));
+    cout << "[** Row generation :: master with " << inp.nF*(inp.nC+1)+1
+         << " variables; worst case by "
+         << (oracle->closedForm ? "closed form" : "LP over the support") << "]" << endl;
+}
+
+/// Peak resident memory of the process (MB)
+double rowgen_peak_memory()
+{
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss/1024.0;
+}
+
+/// Report of the row generation solver, and comparison with the dualized model (-R 2)
+/**
+ * `start` is the time at which the master was built and `rgPeak` the peak
+ * memory before. Then, the dualized model (see define_DUAL_CFLP()) is built
+ * and solved on the same support, with the same parameters. Since the peak
+ * memory of the process never decreases, the memory of each approach is the
+ * increase of the peak during its build and solve: the row generation
+ * solver is run first, so the figure for the (larger) dualized model is not
+ * hidden by it.
+ */
+void rowgen_compare(INSTANCE & inp, SOLUTION & opt, chrono::system_clock::time_point start,
+                    double rgPeak, bool compare)
+{
+    double rgTime = chrono::duration<double>(chrono::system_clock::now()-start).count();
+    double rgMem  = rowgen_peak_memory() - rgPeak;
+    cout << "[** Row generation :: " << rowgenCapCuts << " capacity rows, "
+         << rowgenCostCuts << " cost rows; " << oracle->nCalls << " oracle calls ("
+         << setprecision(4) << oracle->time << " s)]" << endl;
+    oracle->end();
+    delete oracle;
+    oracle = NULL;
+    if (!compare)
+        return;
+
+    cout << "[** Row generation :: solving the dualized model]" << endl;
+    double dualPeak = rowgen_peak_memory();
+    auto dualStart  = chrono::system_clock::now();
+    IloModel dualModel(env, "cflp-dual");
+    IloCplex dualCplex(dualModel);
+    define_DUAL_CFLP(inp, dualModel);
+    dualCplex.setOut(env.getNullStream());
+    dualCplex.setParam(IloCplex::Param::Threads, nThreads);
+    dualCplex.setParam(IloCplex::Param::Parallel, parallelMode);
+    dualCplex.setParam(IloCplex::ClockType, 2);
+    dualCplex.setParam(IloCplex::TiLim, timeLimit);
+    double zDual = IloInfinity;
+    if (dualCplex.solve())
+        zDual = dualCplex.getObjValue();
+    double dualTime = chrono::duration<double>(chrono::system_clock::now()-dualStart).count();
+    double dualMem  = rowgen_peak_memory() - dualPeak;
+    dualCplex.end();
+    dualModel.end();
+
+    cout << endl << "** ROW GENERATION vs DUALIZED MODEL **" << endl;
+    cout << setw(16) << "method" << setw(12) << "time" << setw(14) << "memory (MB)"
+         << setw(20) << "z*" << endl;
+    cout << setw(16) << "row generation" << setw(12) << setprecision(4) << rgTime
+         << setw(14) << rgMem << setw(20) << setprecision(12) << opt.zStar << endl;
+    cout << setw(16) << "dualized" << setw(12) << setprecision(4) << dualTime
+         << setw(14) << dualMem << setw(20) << setprecision(12) << zDual << endl;
+    cout << setprecision(6) << endl;
+}
@@ -0,0 +1,190 @@
+/***************************************************************************
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+/*! \file trajectory.cpp
+  \brief Progress trajectory of the MIP solves (flag -Y).
+
+ * With **-Y** `file`, each MIP solve of the run writes to `file` the
+ * trajectory of its progress, as sampled by an informational callback
+ * (TrajectoryCallback, or native_trajectory_callback() with the native
+ * builder). A sample is taken every **-I** seconds (default 1), whenever
+ * the incumbent improves, and at the end of the solve. Each sample has:
+ * - `instance`, `version`, `support` : as in the result row;
+ * - `solve` : number of the solve in the run, from 1 (e.g., one per point
+ *   of a sweep, or per method of a comparison);
+ * - `time` : wall-clock seconds since the start of the solve;
+ * - `incumbent`, `bound` : best integer and best bound (`inf`, or `null`
+ *   in JSONL, if there is none yet);
+ * - `gap` : \f$|incumbent - bound| / (10^{-10} + |incumbent|)\f$, i.e., the
+ *   relative gap of cplex;
+ * - `nodes`, `open` : nodes processed and nodes left.
+ *
+ * The file is in JSONL format (one object per sample) if its name ends
+ * with `.jsonl`, and in csv format (`;` separated, with a header line)
+ * otherwise. Informational callbacks do not disable dynamic search, so the
+ * trajectory is the one of the run without **-Y**, and time-to-target or
+ * anytime-performance curves can be built from it for each formulation.
+ */
+
+#include <ilcplex/ilocplex.h>
+ILOSTLBEGIN
+
+#include <iostream>
+#include <cstdlib>
+#include <cmath>
+#include <string>
+#include <chrono>
+#include <mutex>
+
+#include "writer.h"
+
+using namespace std;
+
+
+extern IloEnv env;
+extern char * _FILENAME;
+extern int version;
+extern int support;
+extern char * _TRAJNAME;
+extern double trajInterval;
+extern double INFTY;
+
+/// State of the trajectory of the current solve
+struct TRAJECTORY {
+    WRITER *fWriter = NULL; //!< Trajectory file (NULL until the first solve)
+    bool    json;       //!< JSONL (true) or csv format
+    int     solve;      //!< Number of the current solve (from 1)
+    chrono::steady_clock::time_point start; //!< Start of the current solve
+    double  last;       //!< Time of the last sample
+    double  incumbent;  //!< Incumbent of the last sample
+    mutex   lock;       //!< Callbacks of different threads write in turn
+};
+TRAJECTORY traj{};
+
+
+/// Write one sample (see the description of the file)
+void trajectory_write(double time, double incumbent, double bound, long nodes, long open)
+{
+    bool   found = incumbent < INFTY;
+    double gap   = found ? fabs(incumbent - bound)/(1e-10 + fabs(incumbent)) : INFTY;
+    WRITER & w   = *traj.fWriter;
+    if (traj.json) // JSON has no infinity: null instead
+    {
+        auto number = [&](const char * key, double v) {
+            w << ",\"" << key << "\":";
+            if (fabs(v) < INFTY)
+                w << v;
+            else
+                w << "null";
+        };
+        w << "{\"instance\":\"" << _FILENAME << "\",\"version\":" << version
+          << ",\"support\":" << support << ",\"solve\":" << traj.solve;
+        number("time", time);
+        number("incumbent", incumbent);
+        number("bound", bound);
+        number("gap", gap);
+        w << ",\"nodes\":" << nodes << ",\"open\":" << open << "}\n";
+    }
+    else
+        w << _FILENAME << ';' << version << ';' << support << ';' << traj.solve << ';' << time
+          << ';' << incumbent << ';' << bound << ';' << gap << ';' << nodes << ';' << open << '\n';
+    traj.last      = time;
+    traj.incumbent = incumbent;
+}
+
+/// Sample of the informational callbacks: written if due (see the description of the file)
+void trajectory_sample(double incumbent, double bound, long nodes, long open)
+{
+    lock_guard<mutex> guard(traj.lock);
+    double time = chrono::duration<double>(chrono::steady_clock::now() - traj.start).count();
+    if (time < traj.last + trajInterval && incumbent >= traj.incumbent)
+        return;
+    trajectory_write(time, incumbent, bound, nodes, open);
+}
+
+/// Start the trajectory of a new solve. Returns false if there is none (no -Y).
+bool trajectory_start()
+{
+    if (_TRAJNAME == NULL)
+        return false;
+    if (traj.fWriter == NULL)
+    {
+        string name  = _TRAJNAME;
+        traj.json    = name.size() >= 6 && name.substr(name.size() - 6) == ".jsonl";
+        traj.fWriter = new WRITER(name);
+        if (!traj.fWriter->good())
+        {
+            cout << "[** Cannot open trajectory file '" << name << "': no trajectory]" << endl;
+            delete traj.fWriter;
+            traj.fWriter = NULL;
+            _TRAJNAME    = NULL;
+            return false;
+        }
+        if (!traj.json)
+            *traj.fWriter << "instance;version;support;solve;time;incumbent;bound;gap;nodes;open\n";
+    }
+    traj.solve++;
+    traj.start     = chrono::steady_clock::now();
+    traj.last      = -INFTY;
+    traj.incumbent = INFTY;
+    return true;
+}
+
+/// Last sample of a solve. The file is flushed, so that it is complete even if the run is killed later.
+void trajectory_stop(double incumbent, double bound, long nodes, long open)
+{
+    double time = chrono::duration<double>(chrono::steady_clock::now() - traj.start).count();
+    trajectory_write(time, incumbent, bound, nodes, open);
+    traj.fWriter->flush();
+    fflush(traj.fWriter->fp);
+}
+
+/// Informational callback of the Concert models
+ILOMIPINFOCALLBACK0(TrajectoryCallback)
+{
+    trajectory_sample(hasIncumbent() ? getIncumbentObjValue() : INFTY, getBestObjValue(),
+                      getNnodes(), getNremainingNodes());
+}
+
+/// Attach the trajectory callback to cplex (flag -Y). Returns false if there is no trajectory.
+bool trajectory_use(IloCplex & cplex, IloCplex::Callback & cb)
+{
+    if (!trajectory_start())
+        return false;
+    cb = cplex.use(TrajectoryCallback(env));
+    return true;
+}
+
+/// Last sample of the solve, and removal of the callback (see trajectory_use())
+void trajectory_end(IloCplex & cplex, IloCplex::Callback & cb)
+{
+    double incumbent = INFTY, bound = -INFTY;
+    long   nodes = 0, open = 0;
+    try
+    {
+        bound = cplex.getBestObjValue();
+        nodes = cplex.getNnodes();
+        open  = cplex.getNnodesLeft();
+        incumbent = cplex.getObjValue();
+    }
+    catch (...) // no incumbent
+    {
+    }
+    trajectory_stop(incumbent, bound, nodes, open);
+    cplex.remove(cb);
+    cb.end();
+}
@@ -0,0 +1,51 @@
+/***************************************************************************
+ *   This program is free software; you can redistribute it and/or modify  *
+ *   it under the terms of the GNU General Public License as published by  *
+ *   the Free Software Foundation; either version 2 of the License, or     *
+ *   (at your option) any later version.                                   *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program; if not, write to the                         *
+ *   Free Software Foundation, Inc.,                                       *
+ *   59 Temple Place - Suite 330, Boston, MA  02111-1307, USA.             *
+ ***************************************************************************/
+
+/*! \file writer.h
+\brief Header file of writer.cpp
+
+*/
+#include <cstdio>
+#include <string>
+#include <functional>
+
+/// Buffered text writer (see writer.cpp)
+struct WRITER {
+    FILE  *fp;     //!< Output file (NULL if it cannot be opened)
+    char  *buf;    //!< Output buffer
+    size_t size;   //!< Size of the buffer
+    size_t used;   //!< Bytes in the buffer
+
+    WRITER(const std::string & filename, size_t size = 1 << 22);
+    ~WRITER();
+
+    bool good() const { return fp != NULL; }
+    void flush();
+    void close();
+    void write(const char * s, size_t n);
+
+    WRITER & operator<<(const char * s);
+    WRITER & operator<<(const std::string & s);
+    WRITER & operator<<(char ch);
+    WRITER & operator<<(int v);
+    WRITER & operator<<(long v);
+    WRITER & operator<<(double v);
+};
+
+size_t format_double(char * out, double v);
+void write_matrix(WRITER & w, int nRows, int nCols, const std::function<double(int, int)> & a,
+                  int nThreads = 0);